@@ -0,0 +1,279 @@
+#include "Benchmark.hpp"
+
+#include <Lynx/Application/Application.hpp>
+#include <Lynx/Components/SkeletalMeshComponent.hpp>
+#include <Lynx/System/AnimationSystem.hpp>
+#include <Lynx/System/FrameClock.hpp>
+#include <Lynx/System/JobSystem.hpp>
+
+#include <assimp/scene.h>
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+//スケルトンのアニメーション評価コスト
+//モデルファイルに依存しないよう、aiSceneを直接組み立てる
+
+namespace
+{
+    constexpr uint32_t boneNum = 16;
+
+    //boneNum個のノードからなる二分木と、全ノードを動かすアニメーション1つ
+    std::shared_ptr<const aiScene> makeAnimatedScene(uint32_t keyNum = 60)
+    {
+        auto scene = new aiScene();
+
+        std::vector<aiNode*> nodes(boneNum);
+        for(uint32_t i = 0; i < boneNum; ++i)
+            nodes[i] = new aiNode("bone" + std::to_string(i));
+
+        for(uint32_t i = 0; i < boneNum; ++i)
+        {
+            std::vector<aiNode*> children;
+            for(uint32_t c = i * 2 + 1; c <= i * 2 + 2 && c < boneNum; ++c)
+                children.emplace_back(nodes[c]);
+
+            if(children.empty())
+                continue;
+
+            nodes[i]->mNumChildren = static_cast<unsigned int>(children.size());
+            nodes[i]->mChildren = new aiNode*[children.size()];
+            for(size_t c = 0; c < children.size(); ++c)
+            {
+                children[c]->mParent = nodes[i];
+                nodes[i]->mChildren[c] = children[c];
+            }
+        }
+        scene->mRootNode = nodes[0];
+
+        auto animation = new aiAnimation();
+        animation->mDuration = keyNum - 1;
+        animation->mTicksPerSecond = 30.;
+        animation->mNumChannels = boneNum;
+        animation->mChannels = new aiNodeAnim*[boneNum];
+        for(uint32_t i = 0; i < boneNum; ++i)
+        {
+            auto channel = new aiNodeAnim();
+            channel->mNodeName = nodes[i]->mName;
+            channel->mNumPositionKeys = channel->mNumRotationKeys = channel->mNumScalingKeys = keyNum;
+            channel->mPositionKeys = new aiVectorKey[keyNum];
+            channel->mRotationKeys = new aiQuatKey[keyNum];
+            channel->mScalingKeys = new aiVectorKey[keyNum];
+            for(uint32_t k = 0; k < keyNum; ++k)
+            {
+                const float s = std::sin(0.1f * static_cast<float>(k + i));
+                const float c = std::cos(0.1f * static_cast<float>(k + i));
+                channel->mPositionKeys[k] = aiVectorKey(k, aiVector3D(0, s, 0));
+                channel->mRotationKeys[k] = aiQuatKey(k, aiQuaternion(c, 0, s, 0));
+                channel->mScalingKeys[k] = aiVectorKey(k, aiVector3D(1.f, 1.f, 1.f));
+            }
+            animation->mChannels[i] = channel;
+        }
+
+        scene->mNumAnimations = 1;
+        scene->mAnimations = new aiAnimation*[1];
+        scene->mAnimations[0] = animation;
+
+        return std::shared_ptr<const aiScene>(scene);
+    }
+
+    Lynx::SkeletalMeshComponent::Skeleton makeSkeleton(const aiScene& scene, const Lynx::AnimationCompression& compression)
+    {
+        Lynx::SkeletalMeshComponent::Skeleton skeleton;
+        skeleton.bones.resize(boneNum);
+        for(uint32_t i = 0; i < boneNum; ++i)
+        {
+            skeleton.bones[i].offset = glm::mat4(1.f);
+            skeleton.bones[i].transform = glm::mat4(1.f);
+            skeleton.boneMap["bone" + std::to_string(i)] = i;
+        }
+        skeleton.setGlobalInverse(glm::mat4(1.f));
+        skeleton.build(scene, compression);
+
+        return skeleton;
+    }
+}
+
+namespace
+{
+    //aiSceneのままアニメーションを持っていた場合のバイト数
+    size_t getSourceMemorySize(const aiScene& scene)
+    {
+        size_t size = 0;
+        for(size_t a = 0; a < scene.mNumAnimations; ++a)
+        {
+            const aiAnimation* animation = scene.mAnimations[a];
+            size += sizeof(aiAnimation) + animation->mNumChannels * sizeof(aiNodeAnim*);
+            for(size_t c = 0; c < animation->mNumChannels; ++c)
+            {
+                const aiNodeAnim* channel = animation->mChannels[c];
+                size += sizeof(aiNodeAnim)
+                    + (channel->mNumPositionKeys + channel->mNumScalingKeys) * sizeof(aiVectorKey)
+                    + channel->mNumRotationKeys * sizeof(aiQuatKey);
+            }
+        }
+
+        return size;
+    }
+
+    //source_bytesとclip_bytesはクリップ1つ分(フレームあたりではない)
+    void updateSkeletons(Lynx::Bench::State& state, uint32_t keyNum, const Lynx::AnimationCompression& compression = Lynx::AnimationCompression())
+    {
+        const auto&& scene = makeAnimatedScene(keyNum);
+        std::vector<Lynx::SkeletalMeshComponent::Skeleton> skeletons(state.entities(), makeSkeleton(*scene, compression));
+        const size_t sourceBytes = getSourceMemorySize(*scene);
+        const size_t clipBytes = skeletons.front().getAnimation(0).getMemorySize();
+
+        float second = 0;
+        while(state.keepRunning())
+        {
+            second += 1.f / 60.f;
+            for(auto& skeleton : skeletons)
+                skeleton.update(second);
+        }
+
+        state.addCounter("source_bytes", static_cast<double>(sourceBytes * state.frames()));
+        state.addCounter("clip_bytes", static_cast<double>(clipBytes * state.frames()));
+    }
+
+    Lynx::AnimationCompression makeLossyCompression()
+    {
+        Lynx::AnimationCompression compression;
+        compression.positionTolerance = 1e-3f;
+        compression.rotationTolerance = 1e-3f;
+        compression.scaleTolerance = 1e-3f;
+
+        return compression;
+    }
+}
+
+LYNX_BENCHMARK(BM_Skeleton_update)
+{
+    updateSkeletons(state, 60);
+}
+
+//長いモーキャプ相当, キーの探索がキー数によらないことを見る
+LYNX_BENCHMARK(BM_Skeleton_update_long_clip)
+{
+    updateSkeletons(state, 10000);
+}
+
+//許容誤差つきでキーを間引いたもの, source_bytesとclip_bytesで圧縮率を見る
+LYNX_BENCHMARK(BM_Skeleton_update_long_clip_reduced)
+{
+    updateSkeletons(state, 10000, makeLossyCompression());
+}
+
+//クロスフェード中(2クリップ)に上半身のレイヤーを1枚重ねた場合, 行列にするのは最後の1回だけ
+LYNX_BENCHMARK(BM_Skeleton_blend)
+{
+    const auto&& scene = makeAnimatedScene();
+    std::vector<Lynx::SkeletalMeshComponent::Skeleton> skeletons(state.entities(), makeSkeleton(*scene, Lynx::AnimationCompression()));
+    const auto& front = skeletons.front();
+    const auto&& mask = front.createMask("bone1");
+    std::vector<uint32_t> cursors(front.getCursorNum() * 3 * skeletons.size(), 0);
+
+    Lynx::AnimationPose pose, blend;
+    float second = 0;
+    while(state.keepRunning())
+    {
+        second += 1.f / 60.f;
+        for(size_t i = 0; i < skeletons.size(); ++i)
+        {
+            auto& skeleton = skeletons[i];
+            uint32_t* cursor = &cursors[skeleton.getCursorNum() * 3 * i];
+            skeleton.samplePose(0, second, cursor, pose);
+            skeleton.samplePose(0, second + 0.5f, cursor + skeleton.getCursorNum(), blend);
+            Lynx::blendPose(pose, blend, 0.5f);
+            skeleton.samplePose(0, second + 1.f, cursor + skeleton.getCursorNum() * 2, blend);
+            Lynx::blendPose(pose, blend, 0.8f, mask.data());
+            skeleton.applyPose(pose);
+        }
+    }
+}
+
+namespace
+{
+    //同じモデルの群衆, 再生位置はphaseNum通りにずらす
+    //evaluatedは実際に姿勢を計算した数
+    void updateCrowd(Lynx::Bench::State& state, bool parallel, bool instancing, uint32_t phaseNum = 8)
+    {
+        const auto&& scene = makeAnimatedScene();
+        const auto&& skeleton = makeSkeleton(*scene, Lynx::AnimationCompression());
+
+        Lynx::FrameClock clock;
+        clock.setFixedDeltaTime(1.f / 60.f);
+        Lynx::FrameClock::setCurrent(&clock);
+
+        Lynx::JobSystem jobSystem;
+        Lynx::AnimationSystem animationSystem;
+        animationSystem.setJobSystem(parallel ? &jobSystem : nullptr);
+        animationSystem.setInstancing(instancing);
+        Lynx::AnimationSystem::setCurrent(&animationSystem);
+
+        std::vector<std::shared_ptr<Lynx::SkeletalMeshComponent>> components(state.entities());
+        for(size_t i = 0; i < components.size(); ++i)
+        {
+            components[i] = std::make_shared<Lynx::SkeletalMeshComponent>();
+            components[i]->create({}, skeleton);
+            components[i]->setAnimationIndex(0);
+            components[i]->setAnimationTime(0.25 * static_cast<double>(i % phaseNum));
+        }
+
+        uint64_t evaluated = 0;
+        while(state.keepRunning())
+        {
+            clock.tick();
+            for(auto& component : components)
+                component->update();
+            animationSystem.evaluate();
+            evaluated += animationSystem.getStatistics().evaluatedCount;
+        }
+
+        state.addCounter("evaluated", static_cast<double>(evaluated));
+
+        //共有した行列が1体ずつ評価したものとビット単位で同じか確かめる(計測の外)
+        //共有しない評価はコンポーネントがその場で評価するのと同じ再生位置で呼ばれる
+        if(instancing)
+        {
+            std::vector<glm::mat4> shared;
+            for(const auto& component : components)
+                for(const auto& bone : component->getBones())
+                    shared.emplace_back(bone.transform);
+
+            animationSystem.setInstancing(false);
+            for(auto& component : components)
+                animationSystem.submit(component.get());
+            animationSystem.evaluate();
+
+            size_t mismatched = 0, k = 0;
+            for(const auto& component : components)
+                for(const auto& bone : component->getBones())
+                    if(std::memcmp(&bone.transform, &shared[k++], sizeof(glm::mat4)) != 0)
+                        ++mismatched;
+
+            if(mismatched > 0)
+                std::fprintf(stderr, "instanced animation differs from per-component evaluation : %zu bone matrices\n", mismatched);
+            assert(mismatched == 0);
+        }
+    }
+}
+
+//コンポーネントごとにその場で評価するのと同じ(1スレッド, 共有なし)
+LYNX_BENCHMARK(BM_AnimationSystem_crowd_serial)
+{
+    updateCrowd(state, false, false);
+}
+
+LYNX_BENCHMARK(BM_AnimationSystem_crowd_parallel)
+{
+    updateCrowd(state, true, false);
+}
+
+//同じ位相のインスタンスは1体だけ評価する
+LYNX_BENCHMARK(BM_AnimationSystem_crowd_instanced)
+{
+    updateCrowd(state, true, true);
+}
@@ -0,0 +1,223 @@
+#include "Benchmark.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace
+{
+    std::atomic<uint64_t> gAllocationCount(0);
+
+    struct Entry
+    {
+        const char* name;
+        Lynx::Bench::Function function;
+    };
+
+    std::vector<Entry>& entries()
+    {
+        static std::vector<Entry> instance;
+        return instance;
+    }
+
+    //これ以上短いと計測がぶれる
+    constexpr double minTimeNs = 2e8;
+    constexpr uint64_t minFrames = 3;
+    constexpr uint64_t maxFrames = 100000;
+}
+
+void* operator new(size_t size)
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if(void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace Lynx::Bench
+{
+    State::State(size_t entities)
+    : mEntities(entities)
+    , mFrames(0)
+    , mStarted(false)
+    , mPaused(false)
+    , mElapsed(Clock::duration::zero())
+    , mAllocStart(0)
+    , mAllocations(0)
+    {
+
+    }
+
+    size_t State::entities() const
+    {
+        return mEntities;
+    }
+
+    bool State::keepRunning()
+    {
+        if(!mStarted)
+        {
+            mStarted = true;
+            mAllocStart = allocationCount();
+            mStart = Clock::now();
+            return true;
+        }
+
+        ++mFrames;
+
+        if(mFrames >= maxFrames || (mFrames >= minFrames && elapsedNanoseconds() >= minTimeNs))
+        {
+            pauseTiming();
+            return false;
+        }
+
+        return true;
+    }
+
+    void State::pauseTiming()
+    {
+        if(mPaused)
+            return;
+
+        mElapsed += Clock::now() - mStart;
+        mAllocations += allocationCount() - mAllocStart;
+        mPaused = true;
+    }
+
+    void State::resumeTiming()
+    {
+        if(!mPaused)
+            return;
+
+        mPaused = false;
+        mAllocStart = allocationCount();
+        mStart = Clock::now();
+    }
+
+    void State::addCounter(const std::string& name, double total)
+    {
+        mCounters.emplace_back(name, total);
+    }
+
+    uint64_t State::frames() const
+    {
+        return mFrames;
+    }
+
+    double State::elapsedNanoseconds() const
+    {
+        auto elapsed = mElapsed;
+        if(!mPaused)
+            elapsed += Clock::now() - mStart;
+
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    uint64_t State::allocations() const
+    {
+        return mAllocations;
+    }
+
+    const std::vector<std::pair<std::string, double>>& State::counters() const
+    {
+        return mCounters;
+    }
+
+    bool registerBenchmark(const char* name, const Function& function)
+    {
+        entries().push_back({name, function});
+        return true;
+    }
+
+    uint64_t allocationCount()
+    {
+        return gAllocationCount.load(std::memory_order_relaxed);
+    }
+}
+
+//使い方 : lynx_bench [--benchmark_filter=<部分文字列>] [--entities=1000,10000]
+int main(int argc, char** argv)
+{
+    const char* filter = nullptr;
+    std::vector<size_t> scales = {1000, 10000, 100000};
+
+    for(int i = 1; i < argc; ++i)
+    {
+        constexpr const char* filterArg = "--benchmark_filter=";
+        constexpr const char* entitiesArg = "--entities=";
+
+        if(std::strncmp(argv[i], filterArg, std::strlen(filterArg)) == 0)
+            filter = argv[i] + std::strlen(filterArg);
+        else if(std::strncmp(argv[i], entitiesArg, std::strlen(entitiesArg)) == 0)
+        {
+            scales.clear();
+            for(char* p = argv[i] + std::strlen(entitiesArg); *p != '\0';)
+            {
+                scales.emplace_back(std::strtoull(p, &p, 10));
+                if(*p == ',')
+                    ++p;
+            }
+        }
+        else
+        {
+            std::fprintf(stderr, "usage : %s [--benchmark_filter=<name>] [--entities=1000,10000,...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("%-48s %10s %14s %14s  %s\n", "Benchmark", "Frames", "ns/entity", "allocs/frame", "counters(per frame)");
+    std::printf("%s\n", std::string(110, '-').c_str());
+
+    for(const auto& entry : entries())
+    {
+        if(filter && !std::strstr(entry.name, filter))
+            continue;
+
+        for(const auto& entities : scales)
+        {
+            Lynx::Bench::State state(entities);
+            entry.function(state);
+
+            const double frames = state.frames() > 0 ? static_cast<double>(state.frames()) : 1.;
+            const std::string name = std::string(entry.name) + "/" + std::to_string(entities);
+
+            std::printf("%-48s %10llu %14.2f %14.2f ", name.c_str(),
+                static_cast<unsigned long long>(state.frames()),
+                state.elapsedNanoseconds() / (frames * static_cast<double>(entities ? entities : 1)),
+                static_cast<double>(state.allocations()) / frames);
+
+            for(const auto& counter : state.counters())
+                std::printf(" %s=%.1f", counter.first.c_str(), counter.second / frames);
+            std::printf("\n");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <utility>
+
+//lynx_bench用の小さなベンチマークハーネス(Google Benchmark風)
+//
+//  LYNX_BENCHMARK(BM_Foo)
+//  {
+//      //準備(計測対象外)
+//      while(state.keepRunning())
+//      {
+//          //1フレーム分の処理
+//      }
+//      state.addCounter("bytes", totalBytes);//フレームあたりに換算して表示される
+//  }
+//
+//各ベンチマークはエンティティ数(1k/10k/100k)ごとに実行され、
+//エンティティあたりの時間とフレームあたりのアロケーション回数を報告します
+
+namespace Lynx::Bench
+{
+    class State
+    {
+    public:
+        State(size_t entities);
+
+        size_t entities() const;
+
+        //計測ループ, 最初の呼び出しで計測を開始する
+        bool keepRunning();
+
+        //計測を一時的に止める(フレームごとのリセット処理など)
+        void pauseTiming();
+        void resumeTiming();
+
+        //全フレーム分の合計値を渡す, 表示はフレームあたり
+        void addCounter(const std::string& name, double total);
+
+        uint64_t frames() const;
+        double elapsedNanoseconds() const;
+        uint64_t allocations() const;
+        const std::vector<std::pair<std::string, double>>& counters() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        size_t mEntities;
+        uint64_t mFrames;
+        bool mStarted;
+        bool mPaused;
+
+        Clock::time_point mStart;
+        Clock::duration mElapsed;
+        uint64_t mAllocStart;
+        uint64_t mAllocations;
+
+        std::vector<std::pair<std::string, double>> mCounters;
+    };
+
+    using Function = std::function<void(State&)>;
+
+    //登録用, LYNX_BENCHMARKから呼ばれる
+    bool registerBenchmark(const char* name, const Function& function);
+
+    //new/deleteのフックで数えた現在までのアロケーション回数
+    uint64_t allocationCount();
+}
+
+#define LYNX_BENCHMARK(NAME) \
+static void NAME(Lynx::Bench::State& state);\
+static const bool NAME##_registered = Lynx::Bench::registerBenchmark(#NAME, NAME);\
+static void NAME(Lynx::Bench::State& state)
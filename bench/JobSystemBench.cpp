@@ -0,0 +1,87 @@
+#include "Benchmark.hpp"
+
+#include <Lynx/System/JobSystem.hpp>
+
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//JobSystemのジョブ投入のオーバーヘッドとparallelForのスケーリング
+
+//空のジョブをN個積んで待つ
+LYNX_BENCHMARK(BM_JobSystem_spawn)
+{
+    Lynx::JobSystem jobSystem;
+
+    while(state.keepRunning())
+    {
+        Lynx::JobSystem::Counter counter;
+        for(size_t i = 0; i < state.entities(); ++i)
+            jobSystem.run([](){}, &counter);
+        jobSystem.wait(counter);
+    }
+
+    const auto& stats = jobSystem.getStatistics();
+    state.addCounter("stolen", static_cast<double>(stats.stolenCount));
+}
+
+//runAfterで1本の鎖にしたジョブ(依存解決のコスト)
+LYNX_BENCHMARK(BM_JobSystem_chain)
+{
+    Lynx::JobSystem jobSystem;
+
+    std::vector<std::unique_ptr<Lynx::JobSystem::Counter>> counters(state.entities());
+    while(state.keepRunning())
+    {
+        state.pauseTiming();
+        for(auto& counter : counters)
+            counter = std::make_unique<Lynx::JobSystem::Counter>();
+        state.resumeTiming();
+
+        jobSystem.run([](){}, counters[0].get());
+        for(size_t i = 1; i < counters.size(); ++i)
+            jobSystem.runAfter(*counters[i - 1], [](){}, counters[i].get());
+        jobSystem.wait(*counters.back());
+    }
+}
+
+//エンティティごとに少し重い計算をするparallelFor, ワーカー数ごと
+//workerCountが0ならJobSystemを通さずに回す(比較用)
+static void parallelFor(Lynx::Bench::State& state, uint32_t workerCount)
+{
+    std::unique_ptr<Lynx::JobSystem> jobSystem;
+    if(workerCount > 0)
+        jobSystem = std::make_unique<Lynx::JobSystem>(workerCount);
+
+    std::vector<float> values(state.entities(), 1.f);
+    auto func = [&values](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; ++i)
+            values[i] = std::sqrt(values[i] * 1.0001f + 0.5f);
+    };
+
+    while(state.keepRunning())
+    {
+        if(jobSystem)
+            jobSystem->parallelFor(0, values.size(), 256, func);
+        else
+            func(0, values.size());
+    }
+}
+
+LYNX_BENCHMARK(BM_JobSystem_parallelFor_serial)
+{
+    parallelFor(state, 0);
+}
+
+LYNX_BENCHMARK(BM_JobSystem_parallelFor_4threads)
+{
+    parallelFor(state, 3);
+}
+
+LYNX_BENCHMARK(BM_JobSystem_parallelFor_allThreads)
+{
+    const uint32_t hardware = std::thread::hardware_concurrency();
+    parallelFor(state, hardware > 1 ? hardware - 1 : 1);
+}
@@ -0,0 +1,146 @@
+#include "Benchmark.hpp"
+
+#include <Lynx/Application/Application.hpp>
+#include <Lynx/System/NullRenderContext.hpp>
+#include <Lynx/Components/MeshComponent.hpp>
+#include <Lynx/Components/MaterialComponent.hpp>
+#include <Lynx/Components/CameraComponent.hpp>
+#include <Lynx/Components/LightComponent.hpp>
+
+//NullRenderContext上でのRenderer::build()のCPUコスト
+
+LYNX_BENCHMARK(BM_Renderer_build)
+{
+    auto&& context = std::make_shared<Lynx::NullRenderContext>();
+    Lynx::Renderer renderer(context, {Cutlass::HWindow()});
+
+    auto&& camera = std::make_shared<Lynx::CameraComponent>();
+    camera->getTransform().setPos(glm::vec3(0, 10.f, -50.f));
+    camera->setLookAt(glm::vec3(0));
+    camera->update();
+    renderer.setCamera(camera);
+
+    auto&& light = std::make_shared<Lynx::LightComponent>();
+    light->setAsDirectionalLight(glm::vec4(1.f), glm::vec3(0, -1.f, 1.f));
+    renderer.add(light);
+
+    auto&& material = std::make_shared<Lynx::MaterialComponent>();
+
+    std::vector<std::shared_ptr<Lynx::MeshComponent>> meshes(state.entities());
+    for(size_t i = 0; i < meshes.size(); ++i)
+    {
+        meshes[i] = std::make_shared<Lynx::MeshComponent>();
+        meshes[i]->createCube(1.0);
+        meshes[i]->getTransform().setPos(glm::vec3(static_cast<float>(i % 100) * 3.f, 0, static_cast<float>(i / 100) * 3.f));
+        meshes[i]->update();
+        renderer.add(meshes[i], material);
+    }
+
+    //1回目はコマンドバッファの初期構築を含むので外す
+    renderer.build();
+    context->resetStatistics();
+
+    uint64_t uniformSkipped = 0;
+    uint64_t culled = 0;
+    uint32_t batches = 0;
+    uint32_t draws = 0;
+    uint32_t pipelineChanges = 0;
+    while(state.keepRunning())
+    {
+        renderer.build();
+        uniformSkipped += renderer.getStatistics().uniformSkipCount;
+        culled += renderer.getStatistics().culledCount;
+        batches = renderer.getStatistics().batchCount;
+        draws = renderer.getStatistics().drawCount;
+        pipelineChanges = renderer.getStatistics().pipelineChangeCount;
+    }
+
+    const auto& stats = context->getStatistics();
+    state.addCounter("ub_bytes", static_cast<double>(stats.writeBufferBytes));
+    state.addCounter("writeBuffer", static_cast<double>(stats.writeBufferCount));
+    state.addCounter("updateCommandBuffer", static_cast<double>(stats.updateCommandBufferCount));
+    state.addCounter("uniform_skip", static_cast<double>(uniformSkipped));
+    state.addCounter("culled", static_cast<double>(culled));
+    state.addCounter("batches", static_cast<double>(batches));
+    state.addCounter("draws", static_cast<double>(draws));
+    state.addCounter("pipeline_changes", static_cast<double>(pipelineChanges));
+}
+
+//シーンロード相当 : N個のメッシュをaddしてclearSceneする
+LYNX_BENCHMARK(BM_Renderer_add)
+{
+    auto&& context = std::make_shared<Lynx::NullRenderContext>();
+    Lynx::Renderer renderer(context, {Cutlass::HWindow()});
+
+    auto&& material = std::make_shared<Lynx::MaterialComponent>();
+
+    std::vector<std::shared_ptr<Lynx::MeshComponent>> meshes(state.entities());
+    for(auto& mesh : meshes)
+    {
+        mesh = std::make_shared<Lynx::MeshComponent>();
+        mesh->createCube(1.0);
+    }
+
+    context->resetStatistics();
+
+    while(state.keepRunning())
+    {
+        for(const auto& mesh : meshes)
+            renderer.add(mesh, material);
+
+        state.pauseTiming();
+        renderer.clearScene();
+        state.resumeTiming();
+    }
+
+    const auto& stats = context->getStatistics();
+    state.addCounter("createGraphicsPipeline", static_cast<double>(stats.createGraphicsPipelineCount));
+    state.addCounter("createBuffer", static_cast<double>(stats.createBufferCount));
+    state.addCounter("buffer_bytes", static_cast<double>(stats.writeBufferBytes));
+}
+
+//シーンロード直後の初回build : マテリアルがすべて違うのでバッチもN個になる
+static void loadScene(Lynx::Bench::State& state, uint32_t recordThreadCount)
+{
+    auto&& context = std::make_shared<Lynx::NullRenderContext>();
+    Lynx::Renderer renderer(context, {Cutlass::HWindow()});
+    renderer.setRecordThreadCount(recordThreadCount);
+
+    std::vector<std::shared_ptr<Lynx::MeshComponent>> meshes(state.entities());
+    std::vector<std::shared_ptr<Lynx::MaterialComponent>> materials(state.entities());
+    for(size_t i = 0; i < meshes.size(); ++i)
+    {
+        meshes[i] = std::make_shared<Lynx::MeshComponent>();
+        meshes[i]->createCube(1.0);
+        materials[i] = std::make_shared<Lynx::MaterialComponent>();
+    }
+
+    uint64_t recorded = 0;
+    while(state.keepRunning())
+    {
+        state.pauseTiming();
+        for(size_t i = 0; i < meshes.size(); ++i)
+            renderer.add(meshes[i], materials[i]);
+        state.resumeTiming();
+
+        renderer.build();
+        recorded += renderer.getStatistics().batchRecordCount;
+
+        state.pauseTiming();
+        renderer.clearScene();
+        state.resumeTiming();
+    }
+
+    state.addCounter("batch_records", static_cast<double>(recorded));
+}
+
+LYNX_BENCHMARK(BM_Renderer_load_serial)
+{
+    loadScene(state, 1);
+}
+
+//並列になるのはSubCommandListの組み立てだけで、createSubCommandBufferは順番に呼ばれる
+LYNX_BENCHMARK(BM_Renderer_load_parallel)
+{
+    loadScene(state, 0);
+}
@@ -0,0 +1,176 @@
+#include "Benchmark.hpp"
+
+#include <Lynx/Application/Application.hpp>
+#include <Lynx/Components/MeshComponent.hpp>
+#include <Lynx/Utility/Transform.hpp>
+
+//アクタ、コンポーネント、Transformの毎フレーム更新コスト
+
+namespace
+{
+    struct BenchCommon
+    {
+
+    };
+
+    class BenchActor : public Lynx::IActor<BenchCommon>
+    {
+        GEN_ACTOR(BenchActor, BenchCommon)
+
+    private:
+        std::weak_ptr<Lynx::MeshComponent> mMesh;
+    };
+
+    BenchActor::~BenchActor()
+    {
+
+    }
+
+    void BenchActor::awake()
+    {
+        mMesh = addComponent<Lynx::MeshComponent>();
+    }
+
+    void BenchActor::init()
+    {
+        auto&& mesh = mMesh.lock();
+        mesh->getTransform().setVel(glm::vec3(1.f, 0, 0));
+        mesh->getTransform().setRotVel(0.5f);
+    }
+
+    void BenchActor::update()
+    {
+
+    }
+
+    //自分のコンポーネントしか触らないと宣言して並列更新に参加する
+    class ParallelBenchActor : public Lynx::IActor<BenchCommon>
+    {
+        GEN_ACTOR(ParallelBenchActor, BenchCommon)
+
+    private:
+        std::weak_ptr<Lynx::MeshComponent> mMesh;
+    };
+
+    ParallelBenchActor::~ParallelBenchActor()
+    {
+
+    }
+
+    void ParallelBenchActor::awake()
+    {
+        mMesh = addComponent<Lynx::MeshComponent>();
+        declareWrite<>();
+    }
+
+    void ParallelBenchActor::init()
+    {
+        auto&& mesh = mMesh.lock();
+        mesh->getTransform().setVel(glm::vec3(1.f, 0, 0));
+        mesh->getTransform().setRotVel(0.5f);
+    }
+
+    void ParallelBenchActor::update()
+    {
+
+    }
+
+    template<typename Actor = BenchActor>
+    std::unique_ptr<Lynx::ActorsInScene<BenchCommon>> makeScene(size_t actorNum)
+    {
+        auto scene = std::make_unique<Lynx::ActorsInScene<BenchCommon>>(std::make_shared<BenchCommon>(), nullptr, std::make_shared<Lynx::System>());
+        for(size_t i = 0; i < actorNum; ++i)
+            scene->template addActor<Actor>("actor" + std::to_string(i));
+
+        //addActorで積まれたinitを消化しておく
+        scene->update();
+
+        return scene;
+    }
+}
+
+LYNX_BENCHMARK(BM_Transform_update)
+{
+    std::vector<Lynx::Transform> transforms(state.entities());
+    for(auto& t : transforms)
+    {
+        t.setVel(glm::vec3(1.f, 0, 0));
+        t.setRotVel(0.5f);
+    }
+
+    while(state.keepRunning())
+    {
+        for(auto& t : transforms)
+            t.update();
+    }
+}
+
+//8つずつの木(根1つに子7つ), 動くのは根だけ, 子のワールド行列は描画側と同じく読んだときに合わせる
+LYNX_BENCHMARK(BM_Transform_hierarchy)
+{
+    std::vector<Lynx::Transform> transforms(state.entities());
+    for(size_t i = 0; i < transforms.size(); ++i)
+    {
+        transforms[i].setPos(glm::vec3(1.f, 0, 0));
+        if(i % 8 == 0)
+            transforms[i].setRotVel(0.5f);
+        else
+            transforms[i].setParent(&transforms[i - i % 8]);
+    }
+
+    while(state.keepRunning())
+    {
+        for(auto& t : transforms)
+            t.update();
+        for(auto& t : transforms)
+            t.getWorldMatrix();
+    }
+}
+
+LYNX_BENCHMARK(BM_IActor_updateAll)
+{
+    auto&& scene = makeScene(state.entities());
+
+    std::vector<std::shared_ptr<Lynx::IActor<BenchCommon>>> actors;
+    actors.reserve(state.entities());
+    scene->forEachActors([&](const std::shared_ptr<Lynx::IActor<BenchCommon>>& actor){actors.emplace_back(actor);});
+
+    while(state.keepRunning())
+    {
+        for(auto& actor : actors)
+            actor->updateAll();
+    }
+}
+
+LYNX_BENCHMARK(BM_ActorsInScene_update)
+{
+    auto&& scene = makeScene(state.entities());
+
+    while(state.keepRunning())
+    {
+        scene->update();
+    }
+}
+
+LYNX_BENCHMARK(BM_ActorsInScene_update_parallel)
+{
+    Lynx::JobSystem jobSystem;
+    auto&& scene = makeScene<ParallelBenchActor>(state.entities());
+    scene->setParallelUpdate(&jobSystem);
+
+    while(state.keepRunning())
+    {
+        scene->update();
+    }
+}
+
+LYNX_BENCHMARK(BM_ActorsInScene_update_pooled)
+{
+    auto&& scene = makeScene(state.entities());
+    scene->setPooledComponentUpdate(true);
+
+    while(state.keepRunning())
+    {
+        scene->update();
+    }
+}
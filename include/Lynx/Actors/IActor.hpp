@@ -1,8 +1,10 @@
 #pragma once
 
 #include <typeinfo>
+#include <cstdint>
 #include <memory>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <Cutlass/Cutlass.hpp>
 #include <iostream>
 
@@ -51,9 +53,12 @@ namespace Lynx
         , mCommonRegion(sceneCommonRegion)
         , mContext(context)
         , mSystem(system)
+        , mParallelUpdate(false)
+        , mReadMask(0)
+        , mWriteMask(0)
         //, mRequireDestroyFlag(false)
         {
-            mComponentsVec.reserve(4);
+            mComponents.reserve(4);
         }
 
         //Noncopyable, Nonmovable
@@ -76,51 +81,96 @@ namespace Lynx
         void updateAll()
         {
             update();
-            for (auto& component : mComponentsVec)
-                if(component->getUpdateFlag())
-                    component->update();
+            for (auto& component : mComponents)
+                if(component.second->getUpdateFlag())
+                    component.second->update();
         }
 
         //なければnullopt, 同型のComponentのうち最も前のものを返します
         template<typename RequiredComponent>
         std::optional<std::weak_ptr<RequiredComponent>> getComponent()
         {
-            const auto& iter = mComponents.find(typeid(RequiredComponent).hash_code());
-            return (iter != mComponents.end()) ? std::make_optional(std::dynamic_pointer_cast<RequiredComponent>(iter->second[0])) : std::nullopt;
+            const size_t type = typeid(RequiredComponent).hash_code();
+            for(const auto& component : mComponents)
+                if(component.first == type)
+                    return std::make_optional(std::weak_ptr<RequiredComponent>(std::dynamic_pointer_cast<RequiredComponent>(component.second)));
+
+            return std::nullopt;
         }
 
         //なければnullopt, 同型のComponentを全て取得します(重い)
         template<typename RequiredComponent>
         std::optional<std::vector<std::weak_ptr<RequiredComponent>>> getComponents()
         {
-            const auto& iter = mComponents.find(typeid(RequiredComponent).hash_code());
-            if (iter != mComponents.end())
-            {   
-                std::vector<std::weak_ptr<RequiredComponent>> rtn;
-                rtn.resize(iter->second.size());
-                for(size_t i = 0; i < rtn.size(); ++i)
-                    rtn[i] = std::dynamic_pointer_cast<RequiredComponent>(iter->second[i]);
-                
-                return std::make_optional(rtn);
-            }
-            else
+            const size_t type = typeid(RequiredComponent).hash_code();
+            std::vector<std::weak_ptr<RequiredComponent>> rtn;
+            for(const auto& component : mComponents)
+                if(component.first == type)
+                    rtn.emplace_back(std::dynamic_pointer_cast<RequiredComponent>(component.second));
+
+            if(rtn.empty())
                 return std::nullopt;
+
+            return std::make_optional(rtn);
+        }
+
+        //ActorsInSceneの並列更新用
+        //宣言していないアクタは他のアクタと同時には更新されない
+        bool getParallelUpdate() const
+        {
+            return mParallelUpdate;
+        }
+
+        uint64_t getReadMask() const
+        {
+            return mReadMask;
+        }
+
+        uint64_t getWriteMask() const
+        {
+            return mWriteMask;
+        }
+
+        //他のアクタと同時に更新してよいか
+        bool conflicts(uint64_t readMask, uint64_t writeMask) const
+        {
+            return (mWriteMask & (readMask | writeMask)) || (mReadMask & writeMask);
+        }
+
+        //型ごとのビット, 64種類を超えると衝突するが余計に直列化されるだけ
+        template<typename T>
+        static uint64_t accessBit()
+        {
+            return uint64_t(1) << (typeid(T).hash_code() % 64);
         }
 
     protected:
 
+        //update()(と自分のコンポーネントのupdate())で自分以外に触るものを型で宣言すると、並列に更新される
+        //自分のコンポーネントしか触らないなら引数なしで呼ぶ, awake()などで1回呼べばよい
+        //並列に更新されている間も、addActor/removeActorと自分へのaddComponentは呼んでよい
+        //エンジン側の共有状態(FrameClock, AnimationSystem, Rendererなど)は宣言の対象外なので、
+        //スレッドセーフでないもの(Rendererへの登録など)に触るアクタは宣言しないこと
+        template<typename... Types>
+        void declareRead()
+        {
+            mParallelUpdate = true;
+            ((mReadMask |= accessBit<Types>()), ...);
+        }
+
+        template<typename... Types>
+        void declareWrite()
+        {
+            mParallelUpdate = true;
+            ((mWriteMask |= accessBit<Types>()), ...);
+        }
+
+        //実体はシーンのComponentStorageに型ごとに詰めて置かれる
         template<typename Component>
         std::weak_ptr<Component> addComponent()
         {
-            auto tmp = std::make_shared<Component>();
-
-            auto&& p = mComponents.emplace(typeid(Component).hash_code(), std::vector<std::shared_ptr<IComponent>>());
-            if(p.second)
-                p.first->second.emplace_back(tmp);
-            else
-                mComponents.at(typeid(Component).hash_code()).emplace_back(tmp);
-            
-            mComponentsVec.emplace_back(tmp);
+            auto tmp = mActors.getComponentStorage().template create<Component>();
+            mComponents.emplace_back(typeid(Component).hash_code(), tmp);
             return tmp;
         }
 
@@ -128,13 +178,8 @@ namespace Lynx
         template<typename Component, typename... Args>
         std::weak_ptr<Component> addComponent(Args... constructArgs)
         {
-            auto tmp = std::make_shared<Component>(constructArgs...);
-            auto&& p = mComponents.emplace(typeid(Component).hash_code(), std::vector<std::shared_ptr<IComponent>>());
-            if(p.second)
-                p.first->second.emplace_back(tmp);
-            else
-                mComponents.at(typeid(Component).hash_code()).emplace_back(tmp);
-            mComponentsVec.emplace_back(tmp);
+            auto tmp = mActors.getComponentStorage().template create<Component>(constructArgs...);
+            mComponents.emplace_back(typeid(Component).hash_code(), tmp);
             return tmp;
         }
 
@@ -144,9 +189,9 @@ namespace Lynx
         }
 
         template<typename Actor>
-		std::weak_ptr<Actor> addActor(const std::string_view actorName, bool autoInit = false)
+		std::weak_ptr<Actor> addActor(const std::string_view actorName)
 		{
-            mActors.template addActor<Actor>(actorName, autoInit);
+            return mActors.template addActor<Actor>(actorName);
         }
 
         template<typename RequiredActor>
@@ -176,9 +221,8 @@ namespace Lynx
         }
 
     private:
-        //キーは型のハッシュ値
-        std::unordered_map<size_t, std::vector<std::shared_ptr<IComponent>>> mComponents;
-        std::vector<std::shared_ptr<IComponent>> mComponentsVec;
+        //(型のハッシュ値, コンポーネント)を追加順に, アクタあたりの数は少ないので型で引くときも前から探す
+        std::vector<std::pair<size_t, std::shared_ptr<IComponent>>> mComponents;
 
         ActorsInScene<CommonRegion>& mActors;
         std::shared_ptr<CommonRegion> mCommonRegion;
@@ -188,5 +232,8 @@ namespace Lynx
         //Cutlass
         std::shared_ptr<Cutlass::Context> mContext;
 
+        bool mParallelUpdate;
+        uint64_t mReadMask;
+        uint64_t mWriteMask;
     };
 };
\ No newline at end of file
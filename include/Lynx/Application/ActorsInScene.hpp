@@ -12,8 +12,11 @@ namespace Lynx
 #include <functional>
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 
 #include "../Actors/IActor.hpp"
+#include "../System/JobSystem.hpp"
+#include "../Components/ComponentStorage.hpp"
 
 //Scene内のアクタを分離して各アクタに配布しやすいようにする
 namespace Lynx
@@ -37,24 +40,45 @@ namespace Lynx
 		, mContext(context)
 		, mSystem(system)
 		, mBeforeActorNum(0)
+		, mJobSystem(nullptr)
+		, mUpdating(false)
+		, mPooledComponentUpdate(false)
 		{
 			//チューニング対象?
 			mActorsVec.reserve(4);
 		}
 
+		//update()の途中(並列更新のワーカーからも)で呼ばれたら、アクタは作ってawake()まで済ませるが
+		//シーンへの登録はupdate()が終わってからになる(それまではgetActor()で見つからない)
 		template<typename Actor>
 		std::weak_ptr<Actor> addActor(const std::string_view actorName)
 		{
 			auto tmp = std::make_shared<Actor>(*this, mCommonRegion, mContext, mSystem);
 			tmp->awake();
+
+			if(mUpdating)
+			{
+				std::lock_guard<std::mutex> lock(mDeferredMutex);
+				mDeferredAdds.emplace_back(static_cast<std::string>(actorName), tmp);
+				return tmp;
+			}
+
 			mActors.emplace(static_cast<std::string>(actorName), tmp);
 			mActorsVec.emplace_back(tmp);
 			mAddedActors.emplace(tmp);
 			return tmp;
 		}
 
+		//update()の途中で呼ばれたら、update()が終わってから反映する
 		void removeActor(const std::string_view actorName)
 		{
+			if(mUpdating)
+			{
+				std::lock_guard<std::mutex> lock(mDeferredMutex);
+				mDeferredRemoves.emplace_back(actorName);
+				return;
+			}
+
 			auto&& itr = mActors.find(static_cast<std::string>(actorName));
 			if(itr == mActors.end())
 				return;
@@ -84,6 +108,29 @@ namespace Lynx
 			std::swap(std::queue<std::shared_ptr<IActor<CommonRegion>>>(), mRemovedActors);
 		}
 
+		//jobSystemを渡すと、declareRead/declareWriteしたアクタを並列に更新する(nullptrで無効)
+		//宣言どうしがぶつかるアクタと宣言していないアクタは追加順に直列で更新されるので、結果はスレッド数によらない
+		//宣言はアクタとコンポーネントどうしのもので、エンジン側の共有状態は含まない
+		//FrameClockの読み取りとAnimationSystem::submit()は並列でよいが、Rendererへの登録などは宣言していないアクタで行うこと
+		void setParallelUpdate(JobSystem* jobSystem)
+		{
+			mJobSystem = jobSystem;
+		}
+
+		//アクタのコンポーネントの実体はここに型ごとに置かれる
+		ComponentStorage& getComponentStorage()
+		{
+			return mComponentStorage;
+		}
+
+		//trueにすると、全アクタのupdate()の後にコンポーネントを型ごとにまとめて更新する
+		//アクタ単位の更新(アクタ, そのコンポーネント, 次のアクタ...)より散らばらないが、順序は変わる
+		//削除したアクタのコンポーネントも、誰かがshared_ptrで持っている間は更新される
+		void setPooledComponentUpdate(bool flag)
+		{
+			mPooledComponentUpdate = flag;
+		}
+
 		//全てのアクタに対しての更新処理、ユーザは呼ぶ必要はありません
 		void update()
 		{
@@ -93,6 +140,18 @@ namespace Lynx
 				mAddedActors.pop();
 			}
 
+			//ここから先のaddActor/removeActorは後で反映する
+			mUpdating = true;
+
+			if(mJobSystem)
+			{
+				updateParallel();
+				if(mPooledComponentUpdate)
+					mComponentStorage.updateAll();
+				applyDeferred();
+				return;
+			}
+
 			//ついでに削除しちゃう
 			auto&& itr = std::remove_if(mActorsVec.begin(), mActorsVec.end(), [&](std::shared_ptr<IActor<CommonRegion>>& actor)
 			{
@@ -102,16 +161,109 @@ namespace Lynx
 					return true;
 				}
 
-				actor->updateAll();
+				updateActor(*actor);
 				return false;
 			});
 
 			//削除
 			mActorsVec.erase(itr, mActorsVec.end());
-			mBeforeActorNum = mActorsVec.size();
+			mBeforeActorNum = static_cast<uint32_t>(mActorsVec.size());
+
+			if(mPooledComponentUpdate)
+				mComponentStorage.updateAll();
+			applyDeferred();
 		}
 
 	private:
+
+		//更新中に呼ばれたaddActor/removeActorを反映する, 同じフレームに追加して削除したものは消える
+		void applyDeferred()
+		{
+			mUpdating = false;
+
+			decltype(mDeferredAdds) adds;
+			decltype(mDeferredRemoves) removes;
+			{
+				std::lock_guard<std::mutex> lock(mDeferredMutex);
+				adds.swap(mDeferredAdds);
+				removes.swap(mDeferredRemoves);
+			}
+
+			for(auto& add : adds)
+			{
+				mActors.emplace(std::move(add.first), add.second);
+				mActorsVec.emplace_back(add.second);
+				mAddedActors.emplace(std::move(add.second));
+			}
+
+			for(const auto& name : removes)
+				removeActor(name);
+		}
+
+		void updateActor(IActor<CommonRegion>& actor)
+		{
+			if(mPooledComponentUpdate)
+				actor.update();
+			else
+				actor.updateAll();
+		}
+
+		void updateParallel()
+		{
+			//先に削除だけ済ませる
+			auto&& itr = std::remove_if(mActorsVec.begin(), mActorsVec.end(), [&](std::shared_ptr<IActor<CommonRegion>>& actor)
+			{
+				if(!mRemovedActors.empty() && actor == mRemovedActors.back())
+				{
+					mRemovedActors.pop();
+					return true;
+				}
+
+				return false;
+			});
+			mActorsVec.erase(itr, mActorsVec.end());
+			mBeforeActorNum = static_cast<uint32_t>(mActorsVec.size());
+
+			//前から順に、宣言がぶつからない間は同じ組にまとめて並列に更新する
+			//ぶつかったら(宣言していないアクタも)そこまでの組を終わらせてから次へ進むので、順序の依存は保たれる
+			size_t begin = 0;
+			uint64_t readMask = 0;
+			uint64_t writeMask = 0;
+			auto flush = [&](size_t end)
+			{
+				mJobSystem->parallelFor(begin, end, mParallelGrain, [this](size_t first, size_t last)
+				{
+					for(size_t i = first; i < last; ++i)
+						updateActor(*mActorsVec[i]);
+				});
+				begin = end;
+				readMask = writeMask = 0;
+			};
+
+			for(size_t i = 0; i < mActorsVec.size(); ++i)
+			{
+				const auto& actor = mActorsVec[i];
+				if(!actor->getParallelUpdate())
+				{
+					flush(i);
+					updateActor(*actor);
+					begin = i + 1;
+					continue;
+				}
+
+				if(actor->conflicts(readMask, writeMask))
+					flush(i);
+
+				readMask |= actor->getReadMask();
+				writeMask |= actor->getWriteMask();
+			}
+
+			flush(mActorsVec.size());
+		}
+
+		//1ジョブあたりのアクタ数
+		static constexpr size_t mParallelGrain = 64;
+
 		std::unordered_map<std::string, std::shared_ptr<IActor<CommonRegion>>> mActors;
 		std::vector<std::shared_ptr<IActor<CommonRegion>>> mActorsVec;
 		std::queue<std::shared_ptr<IActor<CommonRegion>>> mRemovedActors;
@@ -122,5 +274,16 @@ namespace Lynx
 		std::shared_ptr<Cutlass::Context> mContext;
 		std::shared_ptr<System> mSystem;
 		uint32_t mBeforeActorNum;
+
+		JobSystem* mJobSystem;
+
+		//update()の間はmActors, mActorsVecなどに触らず、ここに積んでおく
+		bool mUpdating;
+		std::mutex mDeferredMutex;
+		std::vector<std::pair<std::string, std::shared_ptr<IActor<CommonRegion>>>> mDeferredAdds;
+		std::vector<std::string> mDeferredRemoves;
+
+		ComponentStorage mComponentStorage;
+		bool mPooledComponentUpdate;
 	};
 };
\ No newline at end of file
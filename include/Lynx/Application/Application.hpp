@@ -18,6 +18,10 @@ namespace Lynx
 #include <optional>
 #include <exception>
 #include <cassert>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <algorithm>
 #include <Cutlass/Cutlass.hpp>
 
 //glmの実装はここで展開
@@ -76,6 +80,10 @@ namespace Lynx
 
 		virtual void update() = 0;
 
+		//Application::run()で回しているときに1フレームに1回, シミュレーションの後に呼ばれる
+		//ここでRendererのbuild(), render()を呼ぶと、Transformは補間された位置で描かれる
+		virtual void render(){};
+
 		inline void initAll()
 		{
 			init();
@@ -84,6 +92,9 @@ namespace Lynx
 		void updateAll()
 		{
 			mActors.update();
+			//コンポーネントが登録したスケルトンをまとめて評価する
+			if(mSystem->animationSystem)
+				mSystem->animationSystem->evaluate();
 			update();
 			//if(!mSceneChanged)
 		}
@@ -214,16 +225,40 @@ namespace Lynx
 			initSystem();
 		}
 
+		//ウィンドウもGPUも使わない(CI, ベンチマーク用)
+		//描画はrenderContext(NullRenderContextなど)に流れ、入力は常に空です
+		Application(std::string_view appName, const std::shared_ptr<IRenderContext>& renderContext)
+		 : mCommonRegion(std::make_shared<CommonRegion>())
+		 , mEndFlag(false)
+		{
+			//仮想ウィンドウ1枚分
+			mHWindows.emplace_back();
+
+			initSystem(renderContext);
+		}
+
 		//Systemを差し替える場合に使ってください
 		//System内の各親を継承していない場合多分壊れます
+		//renderContextを渡すとRendererはCutlass::Contextの代わりにそれを使います
 		template<typename InheritedRenderer = Renderer, typename InheritedLoader = Loader, typename InheritedInput = Input>
-		void initSystem()
+		void initSystem(const std::shared_ptr<IRenderContext>& renderContext = nullptr)
 		{
 			//ApplicationごとにSystem内部を選べれば色々できると思う
 			mSystem = std::make_shared<System>();
-			mSystem->renderer = std::make_unique<InheritedRenderer>(mContext, mHWindows);
+			mSystem->jobSystem = std::make_unique<JobSystem>();
+			mSystem->frameClock = std::make_unique<FrameClock>();
+			FrameClock::setCurrent(mSystem->frameClock.get());
+			mSystem->animationSystem = std::make_unique<AnimationSystem>();
+			mSystem->animationSystem->setJobSystem(mSystem->jobSystem.get());
+			AnimationSystem::setCurrent(mSystem->animationSystem.get());
+			if(renderContext)
+				mSystem->renderer = std::make_unique<InheritedRenderer>(renderContext, mHWindows);
+			else
+				mSystem->renderer = std::make_unique<InheritedRenderer>(mContext, mHWindows);
 			mSystem->loader = std::make_unique<InheritedLoader>(mContext);
 			mSystem->input = std::make_unique<InheritedInput>(mContext);
+
+			mSystem->renderer->setJobSystem(mSystem->jobSystem.get());
 		}
 
 		//Noncopyable, Nonmoveable
@@ -234,7 +269,8 @@ namespace Lynx
 
 		~Application()
 		{
-			mContext->destroy();
+			if(mContext)
+				mContext->destroy();
 		}
 
 		void init(const Key_t& firstSceneKey)
@@ -251,16 +287,59 @@ namespace Lynx
 
 		void update()
 		{
-			//入力更新
-#ifdef _DEBUG
-			assert(Cutlass::Result::eSuccess == mContext->updateInput());
-#else
-			mContext->updateInput();
-#endif
+			updateInput();
+			//時刻はここで1回だけ測る
+			mSystem->frameClock->tick();
 			//全体更新
 			mCurrent.second->updateAll();
 		}
 
+		//終了するまで固定ステップでシミュレーションを回す
+		//Sceneのupdate()はfixedDeltaTime秒ごとに(1フレームに0回以上)、render()は1フレームに1回呼ばれる
+		//targetFrameRateが0より大きければ、余った時間はビジーウェイトせずに眠る
+		//追いつけないときは1フレームmaxStepsPerFrame回までで遅れを捨てる(処理落ちが連鎖しないように)
+		void run(float fixedDeltaTime = 1.f / 60.f, float targetFrameRate = 0, uint32_t maxStepsPerFrame = 5)
+		{
+			assert(fixedDeltaTime > 0);
+			assert(maxStepsPerFrame > 0);
+
+			auto& clock = *mSystem->frameClock;
+			const auto framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(targetFrameRate > 0 ? 1. / targetFrameRate : 0));
+			auto nextFrame = std::chrono::steady_clock::now();
+			double accumulator = 0;
+			clock.measure();
+
+			while(!endAll())
+			{
+				updateInput();
+
+				accumulator += std::min<double>(clock.measure(), clock.getMaxDeltaTime());
+				for(uint32_t step = 0; accumulator >= fixedDeltaTime && step < maxStepsPerFrame; ++step)
+				{
+					clock.advance(fixedDeltaTime);
+					mCurrent.second->updateAll();
+					accumulator -= fixedDeltaTime;
+				}
+
+				if(accumulator >= fixedDeltaTime)
+					accumulator = std::fmod(accumulator, static_cast<double>(fixedDeltaTime));
+
+				clock.setInterpolationAlpha(static_cast<float>(accumulator / fixedDeltaTime));
+				mCurrent.second->render();
+
+				//フレームの頭を一定間隔に揃える, 間に合わなかったら今から数え直す
+				if(targetFrameRate > 0)
+				{
+					nextFrame += framePeriod;
+					const auto now = std::chrono::steady_clock::now();
+					if(nextFrame < now)
+						nextFrame = now;
+					else
+						std::this_thread::sleep_until(nextFrame);
+				}
+			}
+		}
+
 		template<typename InheritedScene>
 		void addScene(const Key_t& key)
 		{
@@ -317,7 +396,7 @@ namespace Lynx
 
 		bool endAll()
 		{
-			return mEndFlag || mContext->shouldClose();
+			return mEndFlag || (mContext && mContext->shouldClose());
 		}
 
 	public:
@@ -330,6 +409,18 @@ namespace Lynx
 
 	private:
 
+		void updateInput()
+		{
+			if(mContext)
+			{
+#ifdef _DEBUG
+				assert(Cutlass::Result::eSuccess == mContext->updateInput());
+#else
+				mContext->updateInput();
+#endif
+			}
+		}
+
 		std::unordered_map<Key_t, Factory_t> mScenesFactory;
 		std::pair<Key_t, Scene_t> mCurrent;
 		std::optional<std::pair<Key_t, Scene_t>> mCache;
@@ -43,6 +43,9 @@ namespace Lynx
         const glm::mat4& getViewMatrix() const;
         const glm::mat4& getProjectionMatrix() const;
 
+        //ビュー/射影行列が変わるたびに更新される
+        uint64_t getVersion() const;
+
         virtual void update();
 
     private:
@@ -59,5 +62,8 @@ namespace Lynx
 
         glm::mat4 mView;
         glm::mat4 mProjection;
+
+        uint64_t mParamVersion;//setterが呼ばれたとき
+        uint64_t mVersion;//行列を計算したときの入力
     };
 };
\ No newline at end of file
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "IComponent.hpp"
+
+namespace Lynx
+{
+    class IComponentPool
+    {
+    public:
+        virtual ~IComponentPool(){};
+
+        //getUpdateFlag()が立っているものを並んでいる順にupdate()する
+        virtual void updateAll() = 0;
+
+        virtual size_t size() const = 0;
+    };
+
+    //同じ型のコンポーネントを固定長のチャンクに値のまま詰めて持つ
+    //空きは番号の小さいスロットから埋めるので、生きているものは前に寄る
+    //全件の走査はチャンクを前から順に読むだけで、ポインタの配列はたどらない
+    //外にはshared_ptrで渡すので、weak_ptrで持っている側(Rendererなど)はそのまま使える(スロットは動かない)
+    //shared_ptrの制御ブロックもこのプールから取るので、コンポーネントごとのヒープ確保はない
+    //作成と破棄はどのスレッドからでもよいが、forEach/updateAllはそれらと同時に呼ばないこと
+    template<typename T>
+    class ComponentPool : public IComponentPool, public std::enable_shared_from_this<ComponentPool<T>>
+    {
+    public:
+        static constexpr uint32_t chunkSize = 256;
+
+        ComponentPool()
+        : mEnd(0)
+        , mCount(0)
+        , mBlockSize(0)
+        , mFreeBlock(nullptr)
+        {
+
+        }
+
+        //Noncopyable
+        ComponentPool(const ComponentPool&) = delete;
+        ComponentPool& operator=(const ComponentPool&) = delete;
+
+        //make_sharedで作っていないので必ずshared_ptrで持つこと
+        template<typename... Args>
+        std::shared_ptr<T> create(Args&&... args)
+        {
+            void* storage = nullptr;
+            const uint32_t slot = allocateSlot(storage);
+
+            //コンストラクタの中で同じ型を作ることもあるので、ロックの外で構築する
+            T* object = nullptr;
+            try
+            {
+                object = new(storage) T(std::forward<Args>(args)...);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                releaseSlot(slot);
+                throw;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mAlive[slot] = 1;
+                mEnd = std::max(mEnd, slot + 1);
+                ++mCount;
+            }
+
+            //プールは最後のコンポーネントが消えるまで(制御ブロックのアロケータが)生かしておく
+            return std::shared_ptr<T>(object, Deleter{this, slot}, BlockAllocator<T>(this->shared_from_this()));
+        }
+
+        //作った後に追加・削除されたものは拾わないことがある
+        template<typename Func>
+        void forEach(Func&& func)
+        {
+            for(uint32_t slot = 0; slot < mEnd; ++slot)
+                if(mAlive[slot])
+                    func(*std::launder(reinterpret_cast<T*>(getSlot(slot))));
+        }
+
+        virtual void updateAll() override
+        {
+            forEach([](T& component)
+            {
+                if(component.getUpdateFlag())
+                    component.update();
+            });
+        }
+
+        virtual size_t size() const override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mCount;
+        }
+
+    private:
+        using Storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+        struct Deleter
+        {
+            ComponentPool* pool;
+            uint32_t slot;
+
+            void operator()(T* object) const
+            {
+                pool->destroy(object, slot);
+            }
+        };
+
+        //shared_ptrの制御ブロック用, 制御ブロックより先にプールが消えないようにshared_ptrで持つ
+        template<typename U>
+        struct BlockAllocator
+        {
+            using value_type = U;
+
+            template<typename V>
+            struct rebind
+            {
+                using other = BlockAllocator<V>;
+            };
+
+            explicit BlockAllocator(std::shared_ptr<ComponentPool> pool_)
+            : pool(std::move(pool_))
+            {
+
+            }
+
+            template<typename V>
+            BlockAllocator(const BlockAllocator<V>& another)
+            : pool(another.pool)
+            {
+
+            }
+
+            U* allocate(size_t n)
+            {
+                return static_cast<U*>(pool->allocateBlock(sizeof(U) * n));
+            }
+
+            void deallocate(U* p, size_t n)
+            {
+                pool->deallocateBlock(p, sizeof(U) * n);
+            }
+
+            template<typename V>
+            bool operator==(const BlockAllocator<V>& another) const
+            {
+                return pool == another.pool;
+            }
+
+            template<typename V>
+            bool operator!=(const BlockAllocator<V>& another) const
+            {
+                return pool != another.pool;
+            }
+
+            std::shared_ptr<ComponentPool> pool;
+        };
+
+        //mChunksは他のスレッドが増やすことがあるので、スロットの場所もロックの中で引く
+        uint32_t allocateSlot(void*& storage_out)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if(mFreeSlots.empty())
+            {
+                const uint32_t base = static_cast<uint32_t>(mChunks.size()) * chunkSize;
+                mChunks.emplace_back(std::make_unique<Storage[]>(chunkSize));
+                mAlive.resize(base + chunkSize, 0);
+                for(uint32_t i = 0; i < chunkSize; ++i)
+                    mFreeSlots.emplace_back(base + i);
+                std::make_heap(mFreeSlots.begin(), mFreeSlots.end(), std::greater<uint32_t>());
+            }
+
+            //一番小さい番号から使う
+            std::pop_heap(mFreeSlots.begin(), mFreeSlots.end(), std::greater<uint32_t>());
+            const uint32_t slot = mFreeSlots.back();
+            mFreeSlots.pop_back();
+
+            storage_out = getSlot(slot);
+            return slot;
+        }
+
+        //ロックした状態で呼ぶ
+        void releaseSlot(uint32_t slot)
+        {
+            mFreeSlots.emplace_back(slot);
+            std::push_heap(mFreeSlots.begin(), mFreeSlots.end(), std::greater<uint32_t>());
+        }
+
+        void* getSlot(uint32_t slot)
+        {
+            return &mChunks[slot / chunkSize][slot % chunkSize];
+        }
+
+        void destroy(T* object, uint32_t slot)
+        {
+            //デストラクタで他のコンポーネントを消すこともあるので、ロックの外で
+            object->~T();
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            mAlive[slot] = 0;
+            --mCount;
+            while(mEnd > 0 && !mAlive[mEnd - 1])
+                --mEnd;
+
+            releaseSlot(slot);
+        }
+
+        //制御ブロックの大きさは型ごとに決まるので、最初に確保したときの大きさの固定長ブロックを空きリストで使い回す
+        void* allocateBlock(size_t size)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if(mBlockSize == 0)
+            {
+                constexpr size_t align = alignof(std::max_align_t);
+                mBlockSize = (std::max(size, sizeof(void*)) + align - 1) / align * align;
+            }
+
+            if(size > mBlockSize)
+                return ::operator new(size);
+
+            if(!mFreeBlock)
+            {
+                auto& chunk = mBlockChunks.emplace_back(std::make_unique<unsigned char[]>(mBlockSize * chunkSize));
+                for(uint32_t i = chunkSize; i > 0; --i)
+                {
+                    void* block = chunk.get() + mBlockSize * (i - 1);
+                    *static_cast<void**>(block) = mFreeBlock;
+                    mFreeBlock = block;
+                }
+            }
+
+            void* block = mFreeBlock;
+            mFreeBlock = *static_cast<void**>(block);
+            return block;
+        }
+
+        void deallocateBlock(void* block, size_t size)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if(size > mBlockSize)
+            {
+                ::operator delete(block);
+                return;
+            }
+
+            *static_cast<void**>(block) = mFreeBlock;
+            mFreeBlock = block;
+        }
+
+        mutable std::mutex mMutex;
+        std::vector<std::unique_ptr<Storage[]>> mChunks;
+        std::vector<uint8_t> mAlive;//スロットごと, 構築が終わってから1になる
+        std::vector<uint32_t> mFreeSlots;//番号の小さい順に取り出すヒープ
+        uint32_t mEnd;//生きている一番後ろのスロットの次
+        size_t mCount;
+
+        size_t mBlockSize;
+        void* mFreeBlock;
+        std::vector<std::unique_ptr<unsigned char[]>> mBlockChunks;
+    };
+
+    //シーン(ActorsInScene)ごとの型別コンポーネントプール
+    class ComponentStorage
+    {
+    public:
+        ComponentStorage() = default;
+
+        //Noncopyable
+        ComponentStorage(const ComponentStorage&) = delete;
+        ComponentStorage& operator=(const ComponentStorage&) = delete;
+
+        template<typename T, typename... Args>
+        std::shared_ptr<T> create(Args&&... args)
+        {
+            static_assert(std::is_base_of_v<IComponent, T>, "T must be derived from IComponent");
+            return getPool<T>().create(std::forward<Args>(args)...);
+        }
+
+        template<typename T>
+        ComponentPool<T>& getPool()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            const auto& itr = mIndices.find(std::type_index(typeid(T)));
+            if(itr != mIndices.end())
+                return static_cast<ComponentPool<T>&>(*mPools[itr->second]);
+
+            mIndices.emplace(std::type_index(typeid(T)), mPools.size());
+            mPools.emplace_back(std::make_shared<ComponentPool<T>>());
+            return static_cast<ComponentPool<T>&>(*mPools.back());
+        }
+
+        //型ごとに, 最初に作られた型から順に更新する
+        //プールの一覧はロックして読むが、各プールの走査はコンポーネントの作成・破棄と同時に呼ばないこと
+        void updateAll();
+
+        //生きているコンポーネントの総数
+        size_t size() const;
+
+    private:
+        mutable std::mutex mMutex;
+        std::unordered_map<std::type_index, size_t> mIndices;
+        std::vector<std::shared_ptr<IComponentPool>> mPools;
+    };
+}
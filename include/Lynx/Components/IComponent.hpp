@@ -3,6 +3,7 @@
 using uint32_t = unsigned int;
 
 #include <memory>
+#include <atomic>
 
 namespace Cutlass
 {
@@ -17,8 +18,9 @@ namespace Lynx
         IComponent()
         : mUpdateFlag(true)
         {
-            static uint32_t IDGen = 0;
-            mID = IDGen++;
+            //並列更新中に作られることもある
+            static std::atomic<uint32_t> IDGen(0);
+            mID = IDGen.fetch_add(1, std::memory_order_relaxed);
         }
 
         virtual ~IComponent(){};
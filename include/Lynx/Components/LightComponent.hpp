@@ -38,6 +38,9 @@ namespace Lynx
         const glm::vec3& getDirection() const;
         const float getRange() const;
 
+        //パラメータか位置が変わるたびに更新される
+        uint64_t getVersion() const;
+
         //const std::optional<Cutlass::HBuffer>& getLightUB() const;
 
 
@@ -56,6 +59,8 @@ namespace Lynx
         glm::vec3 mDirection;
         float mRange;
 
+        uint64_t mParamVersion;
+
         //std::optional<Cutlass::HBuffer> mUB;
     };
 }
\ No newline at end of file
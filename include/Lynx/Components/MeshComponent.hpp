@@ -31,12 +31,25 @@ namespace Lynx
             }
         };
 
+        //ローカル空間の境界(AABBと、それを包む球)
+        struct Bounds
+        {
+            glm::vec3 min;
+            glm::vec3 max;
+            glm::vec3 center;
+            float radius;
+
+            void compute(const std::vector<Vertex>& vertices);
+            void merge(const Bounds& another);
+        };
+
         struct Mesh 
 	    {
             std::vector<MeshComponent::Vertex> vertices;
             std::vector<uint32_t> indices;
             std::string nodeName;
             std::string meshName;
+            Bounds bounds;//create時に計算される
         };
 
         // struct CPUVertex
@@ -83,6 +96,9 @@ namespace Lynx
 
         const std::vector<Mesh>& getMeshes() const;
 
+        //全メッシュを合わせた境界
+        const Bounds& getBounds() const;
+
         // const std::vector<Vertex>& getVertices() const;
         // const std::vector<uint32_t>& getIndices() const; 
 
@@ -99,6 +115,9 @@ namespace Lynx
         Transform mTransform;
 
         std::vector<Mesh> mMeshes;
+        Bounds mBounds;
+
+        void computeBounds();
 
         Cutlass::Topology mTopology;
         Cutlass::RasterizerState mRasterizerState;
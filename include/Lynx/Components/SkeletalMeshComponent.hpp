@@ -5,15 +5,25 @@
 
 #include <typeinfo>
 #include <optional>
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <cstdint>
 
 #include "MeshComponent.hpp"
 
 #include "../Utility/Transform.hpp"
+#include "../Utility/AnimationClip.hpp"
 
-#include <assimp/scene.h>
+//読み込み時にだけ使う
+struct aiNode;
+struct aiScene;
 
 namespace Lynx
 {
+    class AnimationSystem;
+
     class SkeletalMeshComponent : public MeshComponent
     {
     public:
@@ -28,34 +38,68 @@ namespace Lynx
         {
             Skeleton()
             : defaultAxis(glm::mat4(1.f))
+            , mCursorAnimation(SIZE_MAX)
             {
 
             }
 
-            ~Skeleton()
-            {
-                scene.reset();
-            }
-
-            void setAIScene(const std::shared_ptr<const aiScene>& s)
-            {
-                scene = s;
-            }
-
             void setGlobalInverse(const glm::mat4& inv)
             {
                 mGlobalInverse = inv;
             }
 
+            //bonesが揃ってから(ロード後に)1回呼ぶ
+            //ノードを親が先に来る配列に平らにし、アニメーションをAnimationClipに変換する
+            //これ以降sceneは使わないので、呼び出し側で解放してよい
+            void build(const aiScene& scene, const AnimationCompression& compression = AnimationCompression());
+
+            //1つのクリップをそのまま再生する
             void update(float second, size_t animationIndex = 0);
 
+            //クリップの姿勢をoutに書く(ブレンド用), cursorsはgetCursorNum()個
+            void samplePose(size_t animationIndex, float second, uint32_t* cursors, AnimationPose& out) const;
+
+            //ローカルの姿勢からbonesを作る
+            void applyPose(const AnimationPose& pose);
+
+            size_t getAnimationNum() const;
+            const AnimationClip& getAnimation(size_t animationIndex) const;
+
+            size_t getNodeNum() const;
+            size_t getCursorNum() const;
+            const AnimationPose& getBindPose() const;
+
+            //nodeNameのノードとその子孫が1, ほかが0のマスク(見つからなければ全部0)
+            std::vector<float> createMask(const std::string& nodeName) const;
+
             std::vector<Bone> bones;
             std::map<std::string, size_t> boneMap;
             glm::mat4 defaultAxis;
         private:
-            void traverseNode(float timeInAnim, size_t animationIndex, const aiNode* node, glm::mat4 parentTransform);
-            std::shared_ptr<const aiScene> scene;
+            struct Node
+            {
+                glm::mat4 transform;//アニメーションがないときのローカル行列
+                uint32_t parent;//ルートはUINT32_MAX, 親は必ず前にある
+                uint32_t bone;//ボーンでなければUINT32_MAX
+                bool animated;//どれかのクリップにキーがある, なければ常にtransformを使う
+            };
+
+            void flattenNode(const aiNode* node, uint32_t parent, std::vector<const aiNode*>& sources);
+
             glm::mat4 mGlobalInverse;
+
+            std::vector<Node> mNodes;
+            std::vector<std::string> mNodeNames;//マスクを作るときだけ使う
+            AnimationPose mBindPose;
+            //クリップのchannelsはmNodesと同じ並び, 同じモデルのインスタンス間で共有する
+            std::shared_ptr<const std::vector<AnimationClip>> mAnimations;
+            std::vector<glm::mat4> mGlobals;//update()の作業用
+            AnimationPose mPose;//update()の作業用
+
+            //再生位置のカーソル, ノードごとに拡大, 回転, 平行移動の前回のキー
+            //順再生なら前回の続きから探すだけで済む
+            std::vector<uint32_t> mCursors;
+            size_t mCursorAnimation;
         };
 
         SkeletalMeshComponent();
@@ -75,15 +119,70 @@ namespace Lynx
         void setAnimationIndex(uint32_t animation);
         const std::optional<uint32_t>& getAnimationIndex() const;
 
+        //今のクリップの再生位置(秒), 群衆で位相をずらすときなど
+        void setAnimationTime(double second);
+        double getAnimationTime() const;
+
+        //duration秒かけて今のクリップから切り替える(0以下ならsetAnimationIndex()と同じ)
+        //フェード中に呼ぶと、フェード元は直前のクリップになる
+        void crossFade(uint32_t animation, float duration);
+
+        //ベースのクリップの上に重ねる, 戻り値はレイヤー番号
+        //additiveならクリップの先頭の姿勢からの差分を足し、そうでなければweightで混ぜる
+        //maskはノードごとの重み(Skeleton::createMask()), 空なら全身
+        size_t addLayer(uint32_t animation, float weight = 1.f, bool additive = false, const std::vector<float>& mask = {});
+        void setLayerWeight(size_t layer, float weight);
+        void clearLayers();
+
+        const Skeleton& getSkeleton() const;
+
         void setTimeScale(float timescale);
         float getTimeScale() const;
 
+        //再生位置を進める, AnimationSystemがあれば評価はそこでまとめて行う
         virtual void update() override;
 
     private:
-        std::chrono::high_resolution_clock::time_point mStart;
+        friend class AnimationSystem;
+
+        struct Playback
+        {
+            uint32_t animation;
+            double time;//時間倍率を掛けた再生位置(秒)
+            std::vector<uint32_t> cursors;
+        };
+
+        struct Layer
+        {
+            Playback playback;
+            float weight;
+            bool additive;
+            std::vector<float> mask;
+            AnimationPose reference;//加算の基準
+        };
+
+        Playback startPlayback(uint32_t animation) const;
+
+        //ブレンドしてbonesを作る, secondは今のクリップの再生位置
+        void evaluate(float second);
+
+        //同じモデルで同じ姿勢のもののボーン行列をそのまま使う
+        void copyBones(const SkeletalMeshComponent& source);
+
         std::optional<Skeleton> mSkeleton;
 		std::optional<uint32_t> mAnimationIndex;
         float mTimeScale;
+
+        std::optional<Playback> mCurrent;
+        std::optional<Playback> mPrevious;//クロスフェード元
+        float mFadeTime;
+        float mFadeDuration;
+        std::vector<Layer> mLayers;
+
+        //update()の作業用
+        AnimationPose mPose;
+        AnimationPose mBlendPose;
+
+        bool mSubmitted;//AnimationSystemに登録済み
     };
 };
\ No newline at end of file
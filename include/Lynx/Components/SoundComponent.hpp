@@ -5,7 +5,6 @@
 #include <portaudio.h>
 
 #include <vector>
-#include <chrono>
 #include <optional>
 
 namespace Lynx
@@ -89,7 +88,7 @@ namespace Lynx
         int mBufPos;                         //バッファポジション
         bool mLoopFlag;                      //ループフラグ
         bool mPlayFlag;                      //再生中かどうか
-        std::chrono::high_resolution_clock::time_point mStartTime;
         double mPlayingDuration;
+        PaTime mStartTime;                   //play()したときのPa_GetStreamTime()
     };
 }
\ No newline at end of file
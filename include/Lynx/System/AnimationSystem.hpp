@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Lynx
+{
+    class JobSystem;
+    class SkeletalMeshComponent;
+    struct AnimationClip;
+
+    //SkeletalMeshComponentのボーン行列をアクタの更新の後にまとめて計算する
+    //update()では再生位置を進めて登録するだけで、evaluate()でワーカーに分けて評価する
+    //同じクリップの同じ位置を再生しているもの(ブレンドなし)は1体だけ評価して行列をコピーする
+    class AnimationSystem
+    {
+    public:
+        struct Statistics
+        {
+            uint32_t submittedCount;
+            uint32_t evaluatedCount;//実際に姿勢を計算した数
+            uint32_t sharedCount;//他のインスタンスの行列をコピーした数
+        };
+
+        AnimationSystem();
+
+        //Noncopyable
+        AnimationSystem(const AnimationSystem&) = delete;
+        AnimationSystem& operator=(const AnimationSystem&) = delete;
+
+        ~AnimationSystem();
+
+        //nullptrならevaluate()は呼び出し側のスレッドだけで回す
+        void setJobSystem(JobSystem* jobSystem);
+
+        //並列更新中に呼ばれてもよい, 同じフレームに2回登録しても1回しか評価しない
+        void submit(SkeletalMeshComponent* component);
+
+        //evaluate()の前に破棄されたもの
+        void cancel(SkeletalMeshComponent* component);
+
+        //登録されたものを全部評価して空にする
+        void evaluate();
+
+        //インスタンス間で姿勢を共有するか
+        void setInstancing(bool instancing);
+        bool getInstancing() const;
+
+        //0より大きければ再生位置をこの秒数単位に丸めて共有する(多少ずれてもよい群衆用)
+        void setTimeQuantum(float timeQuantum);
+        float getTimeQuantum() const;
+
+        //1つのジョブで評価する数
+        void setGrain(uint32_t grain);
+
+        //直前のevaluate()の結果
+        const Statistics& getStatistics() const;
+
+        //SkeletalMeshComponentが登録する先, Applicationが自分のSystemのものを設定する
+        //設定されていなければコンポーネントはupdate()の中でその場で評価する
+        static void setCurrent(AnimationSystem* animationSystem);
+        static AnimationSystem* getCurrent();
+
+    private:
+        struct Instance
+        {
+            const AnimationClip* clip;//同じモデルのスケルトンはクリップを共有している
+            float time;
+            uint32_t timeBits;//timeのビット列, 並べ替えとまとめるときに使う
+            SkeletalMeshComponent* component;
+        };
+
+        std::mutex mMutex;
+        std::vector<SkeletalMeshComponent*> mSubmitted;
+
+        //evaluate()の作業用
+        std::vector<Instance> mInstances;
+        std::vector<std::pair<SkeletalMeshComponent*, float>> mLeaders;//(評価するもの, 再生位置)
+        std::vector<std::pair<SkeletalMeshComponent*, SkeletalMeshComponent*>> mFollowers;//(コピー先, コピー元)
+
+        JobSystem* mJobSystem;
+        bool mInstancing;
+        float mTimeQuantum;
+        uint32_t mGrain;
+        Statistics mStatistics;
+    };
+}
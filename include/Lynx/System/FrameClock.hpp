@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace Lynx
+{
+    //エンジン全体で1つのフレーム時計
+    //実時間の計測はtick()の1回だけで、コンポーネントはここからdeltaを読む
+    //固定ステップにすると実時間に関係なく同じ幅で進むので、シミュレーションを再現できる
+    class FrameClock
+    {
+    public:
+        FrameClock();
+
+        //Noncopyable
+        FrameClock(const FrameClock&) = delete;
+        FrameClock& operator=(const FrameClock&) = delete;
+
+        ~FrameClock();
+
+        //1フレームに1回呼ぶ, 前回のtick()からの実時間(固定ステップならその幅)だけ進める
+        void tick();
+
+        //実時間を測らずにrealDeltaTime秒進める(ループを自前で回す場合, リプレイ用)
+        void advance(double realDeltaTime);
+
+        //前回のtick(), measure()から実時間で何秒経ったか(切り詰めない)
+        double measure();
+
+        //時間倍率とポーズを反映した, 今回のフレームの経過秒数
+        float getDeltaTime() const;
+
+        //倍率とポーズを反映しない経過秒数(音声など実時間で進むもの用)
+        float getUnscaledDeltaTime() const;
+
+        //getDeltaTime()の累計
+        double getTime() const;
+
+        uint64_t getFrameCount() const;
+
+        void setTimeScale(float timeScale);
+        float getTimeScale() const;
+
+        void setPaused(bool paused);
+        bool isPaused() const;
+
+        //0より大きければ固定ステップ, 0なら実時間
+        void setFixedDeltaTime(float fixedDeltaTime);
+        float getFixedDeltaTime() const;
+
+        //固定ステップで回しているとき, 描画が前回と今回のシミュレーションの間のどこにいるか(0~1)
+        //tick()で1に戻る
+        void setInterpolationAlpha(float alpha);
+        float getInterpolationAlpha() const;
+
+        //ブレークポイントやロードで止まった後に巨大なdeltaが出ないよう切り詰める
+        void setMaxDeltaTime(float maxDeltaTime);
+        float getMaxDeltaTime() const;
+
+        //コンポーネントが読む時計, Applicationが自分のSystemのものを設定する
+        //設定されていなければ進まない時計を返す(ベンチマークなど)
+        static void setCurrent(FrameClock* clock);
+        static const FrameClock& getCurrent();
+
+    private:
+        std::chrono::steady_clock::time_point mPrev;
+
+        float mDeltaTime;
+        float mUnscaledDeltaTime;
+        double mTime;
+        uint64_t mFrameCount;
+
+        float mTimeScale;
+        bool mPaused;
+        float mFixedDeltaTime;
+        float mMaxDeltaTime;
+        float mInterpolationAlpha;
+    };
+}
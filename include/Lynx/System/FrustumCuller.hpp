@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace Lynx
+{
+    class JobSystem;
+
+    //ビュー射影行列から取り出した6平面(法線は内向き, 正規化済み)
+    struct Frustum
+    {
+        glm::vec4 planes[6];
+
+        //clip = viewProj * worldとなる行列から作る
+        static Frustum fromMatrix(const glm::mat4& viewProj);
+    };
+
+    //ワールド空間の境界球をまとめて視錐台と判定する
+    //SoAで持っておくとループがそのままベクトル化される
+    class FrustumCuller
+    {
+    public:
+        FrustumCuller();
+
+        void clear();
+        void reserve(size_t size);
+
+        //追加した順のインデックスを返す
+        uint32_t add(const glm::vec3& center, float radius);
+
+        size_t size() const;
+
+        //visible_out[i]は可視なら1, size()個に揃えられる
+        //戻り値は可視の数, jobSystemを渡すと範囲を分けて並列に判定する
+        uint32_t cull(const Frustum& frustum, std::vector<uint8_t>& visible_out, JobSystem* jobSystem = nullptr) const;
+
+    private:
+        //[begin, end)だけ判定して可視の数を返す
+        uint32_t cullRange(const Frustum& frustum, size_t begin, size_t end, uint8_t* visible) const;
+
+        std::vector<float> mX;
+        std::vector<float> mY;
+        std::vector<float> mZ;
+        std::vector<float> mRadius;
+    };
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <Cutlass/Cutlass.hpp>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "RenderContext.hpp"
+#include "../Components/MeshComponent.hpp"
+
+namespace Lynx
+{
+    //大きな頂点/インデックスバッファ(ページ)を切り分けてメッシュに割り当てるアロケータ
+    //描画はページのバインド + firstIndex/vertexOffsetで行う
+    //CutlassのwriteBufferはオフセットを取れないので、CPU側にミラーを持って先頭から変更のあった所までを転送する
+    //小さいメッシュを足すたびに大きな転送が起きないよう、ページは小さめにしておく
+    class GeometryArena
+    {
+    public:
+        using Handle = uint32_t;
+
+        struct Range
+        {
+            uint32_t page;
+            uint32_t vertexOffset;
+            uint32_t vertexCount;
+            uint32_t firstIndex;
+            uint32_t indexCount;
+        };
+
+        struct Statistics
+        {
+            uint32_t pageCount;
+            uint32_t allocationCount;
+            uint64_t usedVertices;
+            uint64_t usedIndices;
+            uint64_t vertexCapacity;
+            uint64_t indexCapacity;
+            uint64_t flushedBytes;
+            uint32_t compactionCount;
+        };
+
+        GeometryArena(const std::shared_ptr<IRenderContext>& context, uint32_t pageVertexCount = 1 << 14, uint32_t pageIndexCount = 1 << 16);
+
+        //Noncopyable
+        GeometryArena(const GeometryArena&) = delete;
+        GeometryArena& operator=(const GeometryArena&) = delete;
+
+        ~GeometryArena();
+
+        //CPUミラーに書き込むだけ, GPUへの転送はflush()で
+        Handle allocate(const MeshComponent::Mesh& mesh);
+
+        void free(Handle handle);
+
+        //コンパクション後は値が変わるので、記録済みのコマンドは作り直すこと
+        const Range& get(Handle handle) const;
+
+        //handleの中身がmeshと同じか(CPUミラーと比べる)
+        bool equals(Handle handle, const MeshComponent::Mesh& mesh) const;
+
+        const Cutlass::HBuffer& getVB(uint32_t page) const;
+        const Cutlass::HBuffer& getIB(uint32_t page) const;
+
+        //変更のあったページの, 先頭から変更のあった所の末尾までを転送する
+        void flush();
+
+        //空き領域の割合がthresholdを超えたページを詰める, 何か動いたらtrue
+        bool compact(float threshold = 0.25f);
+
+        const Statistics& getStatistics() const;
+
+    private:
+        struct Block
+        {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        //first-fitで取り出す
+        class FreeList
+        {
+        public:
+            void reset(uint32_t capacity);
+            bool allocate(uint32_t size, uint32_t& offset_out);
+            void free(uint32_t offset, uint32_t size);
+            uint32_t getFreeSize() const;
+
+        private:
+            std::vector<Block> mBlocks;//offset順, 隣接するものは結合済み
+        };
+
+        struct Page
+        {
+            Cutlass::HBuffer VB;
+            Cutlass::HBuffer IB;
+            uint32_t vertexCapacity;
+            uint32_t indexCapacity;
+            FreeList vertexFreeList;
+            FreeList indexFreeList;
+            std::vector<MeshComponent::Vertex> vertices;
+            std::vector<uint32_t> indices;
+            //ここまで(要素数)に転送していない変更がある, 0なら転送済み
+            uint32_t vertexDirtyEnd;
+            uint32_t indexDirtyEnd;
+            bool freed;//前回のcompact()以降にfree()されたか
+        };
+
+        struct Allocation
+        {
+            Range range;
+            bool alive;
+        };
+
+        uint32_t createPage(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+        std::shared_ptr<IRenderContext> mContext;
+        const uint32_t mPageVertexCount;
+        const uint32_t mPageIndexCount;
+
+        std::vector<Page> mPages;
+        std::vector<Allocation> mAllocations;
+        std::vector<Handle> mFreeHandles;
+
+        Statistics mStatistics;
+    };
+}
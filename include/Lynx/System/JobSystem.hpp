@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Lynx
+{
+    //ワークスティーリング型のジョブスケジューラ
+    //ワーカーごとに両端キューを持ち、自分のキューは後ろから、他人のキューは前から取る
+    //ワーカー以外のスレッド(メインスレッド)から積んだジョブは共有のキューに入る
+    class JobSystem
+    {
+    public:
+        using Job = std::function<void()>;
+
+        //完了待ち用, ジョブを積むたびに増えて終わるたびに減る
+        //0になったときにrunAfterで登録されたジョブが積まれる
+        class Counter
+        {
+        public:
+            Counter();
+
+            //Noncopyable, Nonmoveable
+            Counter(const Counter&) = delete;
+            Counter& operator=(const Counter&) = delete;
+
+            bool done() const;
+
+        private:
+            friend class JobSystem;
+
+            struct Continuation
+            {
+                Job job;
+                Counter* counter;
+            };
+
+            std::atomic<uint32_t> mPending;
+            mutable std::mutex mMutex;
+            std::vector<Continuation> mContinuations;
+        };
+
+        struct Statistics
+        {
+            uint64_t executedCount;
+            uint64_t stolenCount;//他のキューから取って実行した数
+        };
+
+        //threadCountはワーカー数, 0ならハードウェアのスレッド数-1(呼び出し側のスレッドも手伝うので)
+        JobSystem(uint32_t threadCount = 0);
+
+        //Noncopyable, Nonmoveable
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        //積まれているジョブは全部終わらせてから止める
+        ~JobSystem();
+
+        //counterを渡すとwait()で完了を待てる
+        void run(Job job, Counter* counter = nullptr);
+
+        //dependencyが0になってから実行する
+        void runAfter(Counter& dependency, Job job, Counter* counter = nullptr);
+
+        //counterが0になるまで、待っている間も他のジョブを実行する
+        void wait(Counter& counter);
+
+        //[begin, end)をgrainごとに分けてfunc(begin, end)を並列に実行し、全部終わるまで待つ
+        template<typename Func>
+        void parallelFor(size_t begin, size_t end, size_t grain, Func&& func)
+        {
+            if(begin >= end)
+                return;
+
+            grain = std::max<size_t>(grain, 1);
+            //ワーカーがいない, もしくは分けるほどの量がない
+            if(mWorkers.empty() || end - begin <= grain)
+            {
+                func(begin, end);
+                return;
+            }
+
+            Counter counter;
+            //最初のチャンクは呼び出し側で実行する
+            for(size_t chunk = begin + grain; chunk < end; chunk += grain)
+            {
+                const size_t chunkEnd = std::min(chunk + grain, end);
+                run([&func, chunk, chunkEnd](){ func(chunk, chunkEnd); }, &counter);
+            }
+
+            func(begin, std::min(begin + grain, end));
+            wait(counter);
+        }
+
+        //ワーカースレッドの数(呼び出し側のスレッドは含まない)
+        uint32_t getWorkerCount() const;
+
+        Statistics getStatistics() const;
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::pair<Job, Counter*>> jobs;
+        };
+
+        void push(Job&& job, Counter* counter);
+
+        //1つ実行できたらtrue
+        bool tryRunOne();
+
+        void execute(std::pair<Job, Counter*>& job);
+
+        void finish(Counter* counter);
+
+        void workerMain(uint32_t index);
+
+        //mQueues[0]は共有キュー, ワーカーiのキューはmQueues[i + 1]
+        std::vector<std::unique_ptr<Queue>> mQueues;
+        std::vector<std::thread> mWorkers;
+
+        std::atomic<bool> mRunning;
+        std::atomic<uint32_t> mQueuedCount;
+        std::mutex mSleepMutex;
+        std::condition_variable mWake;
+
+        std::atomic<uint64_t> mExecutedCount;
+        std::atomic<uint64_t> mStolenCount;
+    };
+}
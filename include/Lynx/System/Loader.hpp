@@ -68,6 +68,9 @@ namespace Lynx
 
         virtual void load(const char* path, std::weak_ptr<TextComponent>& text_out);
 
+        //以降に読み込むスケルタルメッシュのアニメーションのキーの間引き方(デフォルトは間引かない)
+        void setAnimationCompression(const AnimationCompression& compression);
+
 
     private:
         void unload();
@@ -94,9 +97,11 @@ namespace Lynx
         std::vector<MaterialComponent::Texture> mTexturesLoaded;
 
         uint32_t mBoneNum;
+        AnimationCompression mAnimationCompression;
 
         Assimp::Importer mImporter;
         //std::shared_ptr<const aiScene> mScene;
+        //読み込み中だけ持つ, Importerからは切り離してある
         std::vector<std::shared_ptr<const aiScene>> mScenes;
     };
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Cutlass/Cutlass.hpp>
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "RenderContext.hpp"
+#include "GeometryArena.hpp"
+#include "../Components/MeshComponent.hpp"
+
+namespace Lynx
+{
+    //同じ形状のメッシュの頂点/インデックスバッファを共有するための参照カウント付き登録簿
+    //キーは頂点とインデックスの内容のハッシュなので、同じモデルを何度ロードしても転送は1回
+    //ハッシュが一致したら中身も比べるので、衝突しても別の形状とは混ざらない
+    //実際の領域はGeometryArenaから切り出すので、VB/IBは他の形状とも共有される
+    class MeshRegistry
+    {
+    public:
+        using Handle = uint32_t;
+
+        struct Geometry
+        {
+            Cutlass::HBuffer VB;
+            Cutlass::HBuffer IB;
+            uint32_t page;
+            uint32_t vertexOffset;
+            uint32_t vertexCount;
+            uint32_t firstIndex;
+            uint32_t indexCount;
+        };
+
+        MeshRegistry(const std::shared_ptr<IRenderContext>& context);
+
+        //Noncopyable
+        MeshRegistry(const MeshRegistry&) = delete;
+        MeshRegistry& operator=(const MeshRegistry&) = delete;
+
+        ~MeshRegistry();
+
+        //なければアリーナに領域を確保する, いずれにせよ参照カウントを1つ増やす
+        Handle acquire(const MeshComponent::Mesh& mesh);
+
+        //参照カウントが0になったら領域を返却する
+        void release(Handle handle);
+
+        //オフセットはcompact()で変わりうる
+        Geometry get(Handle handle) const;
+
+        //描画前に呼ぶ
+        void flush();
+
+        //何か動いたらtrue(記録済みのコマンドは作り直しが必要)
+        bool compact();
+
+        const GeometryArena& getArena() const;
+
+        //実際にGPU上にある形状の数
+        size_t size() const;
+
+        //既存の形状を使い回せたacquireの回数
+        uint64_t getSharedCount() const;
+
+    private:
+        struct Key
+        {
+            uint64_t hash;
+            uint32_t vertexCount;
+            uint32_t indexCount;
+
+            bool operator==(const Key& another) const;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct Entry
+        {
+            Key key;
+            GeometryArena::Handle allocation;
+            uint32_t refCount;
+        };
+
+        static Key makeKey(const MeshComponent::Mesh& mesh);
+
+        GeometryArena mArena;
+
+        std::vector<Entry> mEntries;
+        std::vector<Handle> mFreeHandles;
+        std::unordered_multimap<Key, Handle, KeyHash> mHandles;//衝突したものは同じキーで並ぶ
+
+        uint64_t mSharedCount;
+    };
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "RenderContext.hpp"
+
+namespace Lynx
+{
+    //GPUを一切触らず、呼ばれた回数と書き込み量だけ数えるContext
+    //CIやベンチマークでRendererのCPU側コストを測るために使う
+    class NullRenderContext : public IRenderContext
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t createBufferCount              = 0;
+            uint64_t writeBufferCount               = 0;
+            uint64_t writeBufferBytes               = 0;
+            uint64_t destroyBufferCount             = 0;
+            uint64_t createTextureCount             = 0;
+            uint64_t createRenderPassCount          = 0;
+            uint64_t createGraphicsPipelineCount    = 0;
+            uint64_t createCommandBufferCount       = 0;
+            uint64_t createSubCommandBufferCount    = 0;
+            uint64_t updateCommandBufferCount       = 0;
+            uint64_t destroyCommandBufferCount      = 0;
+            uint64_t executeCount                   = 0;
+        };
+
+        //仮想ウィンドウ(とテクスチャ)の大きさ
+        NullRenderContext(uint32_t width = 640, uint32_t height = 480);
+
+        virtual ~NullRenderContext() override;
+
+        const Statistics& getStatistics() const;
+        void resetStatistics();
+
+        virtual Cutlass::Result getWindowSize(const Cutlass::HWindow& handle, uint32_t& width, uint32_t& height) override;
+
+        virtual Cutlass::Result createBuffer(const Cutlass::BufferInfo& info, Cutlass::HBuffer& handle_out) override;
+        virtual Cutlass::Result writeBuffer(const size_t size, const void* const pData, const Cutlass::HBuffer& handle) override;
+        virtual Cutlass::Result destroyBuffer(const Cutlass::HBuffer& handle) override;
+
+        virtual Cutlass::Result createTexture(const Cutlass::TextureInfo& info, Cutlass::HTexture& handle_out) override;
+        virtual Cutlass::Result createTextureFromFile(const char* path, Cutlass::HTexture& handle_out) override;
+        virtual Cutlass::Result getTextureSize(const Cutlass::HTexture& handle, uint32_t& width, uint32_t& height, uint32_t& depth) override;
+
+        virtual Cutlass::Result createRenderPass(const Cutlass::RenderPassInfo& info, Cutlass::HRenderPass& handle_out) override;
+        virtual Cutlass::Result createGraphicsPipeline(const Cutlass::GraphicsPipelineInfo& info, Cutlass::HGraphicsPipeline& handle_out) override;
+
+        virtual Cutlass::Result createCommandBuffer(const std::vector<Cutlass::CommandList>& commandLists, Cutlass::HCommandBuffer& handle_out) override;
+        virtual Cutlass::Result createCommandBuffer(const Cutlass::CommandList& commandList, Cutlass::HCommandBuffer& handle_out) override;
+        virtual Cutlass::Result createSubCommandBuffer(const Cutlass::SubCommandList& subCommandList, Cutlass::HCommandBuffer& handle_out) override;
+        virtual Cutlass::Result updateCommandBuffer(const Cutlass::CommandList& commandList, const Cutlass::HCommandBuffer& handle) override;
+        virtual Cutlass::Result destroyCommandBuffer(const Cutlass::HCommandBuffer& handle) override;
+
+        virtual Cutlass::Result execute(const Cutlass::HCommandBuffer& handle) override;
+
+    private:
+        //作るたびに別のハンドルを返す, 0は未初期化のハンドルと区別するため使わない
+        template<typename Handle>
+        void issue(Handle& handle_out)
+        {
+            handle_out = Handle(++mHandleCount);
+        }
+
+        uint32_t mWidth;
+        uint32_t mHeight;
+
+        uint32_t mHandleCount;
+        Statistics mStatistics;
+    };
+}
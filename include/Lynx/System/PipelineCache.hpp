@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Cutlass/Cutlass.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "RenderContext.hpp"
+
+namespace Lynx
+{
+    //ラスタライザステート、トポロジ等だけが違うパイプラインを使い回すためのキャッシュ
+    //シェーダの組とレンダーパスは"パス"として名前付きで登録しておく
+    class PipelineCache
+    {
+    public:
+        struct Key
+        {
+            Key(uint32_t pass, Cutlass::DepthStencilState depthStencilState, const Cutlass::RasterizerState& rasterizerState, Cutlass::Topology topology);
+
+            bool operator==(const Key& another) const;
+
+            uint32_t pass;//addPassの戻り値
+            Cutlass::DepthStencilState depthStencilState;
+            Cutlass::PolygonMode polygonMode;
+            Cutlass::CullMode cullMode;
+            Cutlass::FrontFace frontFace;
+            float lineWidth;
+            Cutlass::Topology topology;
+        };
+
+        PipelineCache(const std::shared_ptr<IRenderContext>& context);
+
+        //Noncopyable
+        PipelineCache(const PipelineCache&) = delete;
+        PipelineCache& operator=(const PipelineCache&) = delete;
+
+        ~PipelineCache();
+
+        //nameはファイルに保存する際の識別子なので実行ごとに変えないこと
+        uint32_t addPass(const char* name, const Cutlass::Shader& vs, const Cutlass::Shader& fs, const Cutlass::HRenderPass& renderPass);
+
+        //同じキーのパイプラインがあればそれを返し、なければ作る
+        Cutlass::Result get(const Key& key, Cutlass::HGraphicsPipeline& handle_out);
+
+        //id_outには作成順の通し番号が入る(ハンドルの代わりに比較やソートに使える)
+        Cutlass::Result get(const Key& key, Cutlass::HGraphicsPipeline& handle_out, uint32_t& id_out);
+
+        //作成済みパイプラインのキー一覧を保存する
+        bool save(const char* path) const;
+
+        //保存されたキーのパイプラインを先に作っておく(登録済みのパスのみ)
+        //CutlassがVkPipelineCacheを公開していないので、ドライバ側のキャッシュまでは残せません
+        bool load(const char* path);
+
+        size_t size() const;
+        uint64_t getHitCount() const;
+        uint64_t getMissCount() const;
+
+    private:
+        struct Pass
+        {
+            std::string name;
+            Cutlass::Shader vs;
+            Cutlass::Shader fs;
+            Cutlass::HRenderPass renderPass;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const;
+        };
+
+        std::shared_ptr<IRenderContext> mContext;
+
+        std::vector<Pass> mPasses;
+        struct Entry
+        {
+            Cutlass::HGraphicsPipeline handle;
+            uint32_t id;
+        };
+
+        std::unordered_map<Key, Entry, KeyHash> mPipelines;
+
+        uint64_t mHitCount;
+        uint64_t mMissCount;
+    };
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Cutlass/Cutlass.hpp>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace Lynx
+{
+    //Rendererが使うCutlass::Contextの機能だけを切り出したもの
+    //差し替えればGPUなしでもRendererを動かせる(NullRenderContext参照)
+    class IRenderContext
+    {
+    public:
+        virtual ~IRenderContext(){};
+
+        virtual Cutlass::Result getWindowSize(const Cutlass::HWindow& handle, uint32_t& width, uint32_t& height) = 0;
+
+        virtual Cutlass::Result createBuffer(const Cutlass::BufferInfo& info, Cutlass::HBuffer& handle_out) = 0;
+        virtual Cutlass::Result writeBuffer(const size_t size, const void* const pData, const Cutlass::HBuffer& handle) = 0;
+        virtual Cutlass::Result destroyBuffer(const Cutlass::HBuffer& handle) = 0;
+
+        virtual Cutlass::Result createTexture(const Cutlass::TextureInfo& info, Cutlass::HTexture& handle_out) = 0;
+        virtual Cutlass::Result createTextureFromFile(const char* path, Cutlass::HTexture& handle_out) = 0;
+        virtual Cutlass::Result getTextureSize(const Cutlass::HTexture& handle, uint32_t& width, uint32_t& height, uint32_t& depth) = 0;
+
+        virtual Cutlass::Result createRenderPass(const Cutlass::RenderPassInfo& info, Cutlass::HRenderPass& handle_out) = 0;
+        virtual Cutlass::Result createGraphicsPipeline(const Cutlass::GraphicsPipelineInfo& info, Cutlass::HGraphicsPipeline& handle_out) = 0;
+
+        virtual Cutlass::Result createCommandBuffer(const std::vector<Cutlass::CommandList>& commandLists, Cutlass::HCommandBuffer& handle_out) = 0;
+        virtual Cutlass::Result createCommandBuffer(const Cutlass::CommandList& commandList, Cutlass::HCommandBuffer& handle_out) = 0;
+        virtual Cutlass::Result createSubCommandBuffer(const Cutlass::SubCommandList& subCommandList, Cutlass::HCommandBuffer& handle_out) = 0;
+        virtual Cutlass::Result updateCommandBuffer(const Cutlass::CommandList& commandList, const Cutlass::HCommandBuffer& handle) = 0;
+        virtual Cutlass::Result destroyCommandBuffer(const Cutlass::HCommandBuffer& handle) = 0;
+
+        virtual Cutlass::Result execute(const Cutlass::HCommandBuffer& handle) = 0;
+    };
+
+    //通常はこれ, Cutlass::Contextにそのまま流す
+    class CutlassRenderContext : public IRenderContext
+    {
+    public:
+        CutlassRenderContext(const std::shared_ptr<Cutlass::Context>& context);
+
+        virtual ~CutlassRenderContext() override;
+
+        const std::shared_ptr<Cutlass::Context>& getContext() const;
+
+        virtual Cutlass::Result getWindowSize(const Cutlass::HWindow& handle, uint32_t& width, uint32_t& height) override;
+
+        virtual Cutlass::Result createBuffer(const Cutlass::BufferInfo& info, Cutlass::HBuffer& handle_out) override;
+        virtual Cutlass::Result writeBuffer(const size_t size, const void* const pData, const Cutlass::HBuffer& handle) override;
+        virtual Cutlass::Result destroyBuffer(const Cutlass::HBuffer& handle) override;
+
+        virtual Cutlass::Result createTexture(const Cutlass::TextureInfo& info, Cutlass::HTexture& handle_out) override;
+        virtual Cutlass::Result createTextureFromFile(const char* path, Cutlass::HTexture& handle_out) override;
+        virtual Cutlass::Result getTextureSize(const Cutlass::HTexture& handle, uint32_t& width, uint32_t& height, uint32_t& depth) override;
+
+        virtual Cutlass::Result createRenderPass(const Cutlass::RenderPassInfo& info, Cutlass::HRenderPass& handle_out) override;
+        virtual Cutlass::Result createGraphicsPipeline(const Cutlass::GraphicsPipelineInfo& info, Cutlass::HGraphicsPipeline& handle_out) override;
+
+        virtual Cutlass::Result createCommandBuffer(const std::vector<Cutlass::CommandList>& commandLists, Cutlass::HCommandBuffer& handle_out) override;
+        virtual Cutlass::Result createCommandBuffer(const Cutlass::CommandList& commandList, Cutlass::HCommandBuffer& handle_out) override;
+        virtual Cutlass::Result createSubCommandBuffer(const Cutlass::SubCommandList& subCommandList, Cutlass::HCommandBuffer& handle_out) override;
+        virtual Cutlass::Result updateCommandBuffer(const Cutlass::CommandList& commandList, const Cutlass::HCommandBuffer& handle) override;
+        virtual Cutlass::Result destroyCommandBuffer(const Cutlass::HCommandBuffer& handle) override;
+
+        virtual Cutlass::Result execute(const Cutlass::HCommandBuffer& handle) override;
+
+    private:
+        std::shared_ptr<Cutlass::Context> mContext;
+    };
+}
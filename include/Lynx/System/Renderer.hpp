@@ -6,8 +6,15 @@
 
 #include <vector>
 #include <memory>
+#include <chrono>
+#include <unordered_map>
 
 #include "../Actors/IActor.hpp"
+#include "RenderContext.hpp"
+#include "PipelineCache.hpp"
+#include "MeshRegistry.hpp"
+#include "FrustumCuller.hpp"
+#include "JobSystem.hpp"
 
 namespace Lynx
 {
@@ -26,6 +33,9 @@ namespace Lynx
 
         Renderer(std::shared_ptr<Cutlass::Context> context, const std::vector<Cutlass::HWindow>& hwindows, const uint16_t frameCount = 3);
 
+        //Contextを差し替える場合(NullRenderContextなど)
+        Renderer(std::shared_ptr<IRenderContext> context, const std::vector<Cutlass::HWindow>& hwindows, const uint16_t frameCount = 3);
+
         //Noncopyable, Nonmoveable
         Renderer(const Renderer&) = delete;
         Renderer& operator=(const Renderer&) = delete;
@@ -59,8 +69,56 @@ namespace Lynx
         //描画コマンド実行
         virtual void render();
 
+        //パイプラインキャッシュの読み書き, 起動時にloadしておけばadd時のパイプライン作成を省ける
+        virtual bool loadPipelineCache(const char* path);
+        virtual bool savePipelineCache(const char* path) const;
+
+        //直近のbuild()の統計
+        struct Statistics
+        {
+            uint32_t uniformWriteCount;//実際に転送した定数バッファの数
+            uint32_t uniformSkipCount;//変化がなかったので転送しなかった数
+            uint64_t uniformWriteBytes;
+            uint32_t commandBufferRebuildCount;//再記録したプライマリコマンドバッファの数
+            float commandBufferRebuildsPerSecond;//直近1秒間の再記録回数
+            uint32_t visibleCount;//視錐台内のメッシュ数
+            uint32_t culledCount;//視錐台カリングで除いたメッシュ数
+            uint32_t shadowCasterCount;//シャドウマップに描く数
+            uint32_t shadowCulledCount;//ライトの視錐台の外なので描かなかった数
+            uint32_t batchCount;//ジオメトリパスで実行したサブコマンドバッファの数
+            uint32_t batchRecordCount;//記録し直したサブコマンドバッファの数
+            uint32_t drawCount;//ジオメトリパスのドローコール数
+            uint32_t pipelineChangeCount;//ジオメトリパスの描画順でパイプラインが切り替わる回数
+            uint32_t materialChangeCount;//同じくマテリアル(テクスチャ)が切り替わる回数
+            uint32_t meshChangeCount;//同じく形状が切り替わる回数
+        };
+
+        const Statistics& getStatistics() const;
+
+        //視錐台カリング(デフォルトで有効)
+        virtual void setFrustumCulling(bool flag);
+
+        //ライトの視錐台(点光源なら届く範囲)の外にある影を描かない(デフォルトで有効)
+        virtual void setShadowCasterCulling(bool flag);
+
+        //平行光源のシャドウマップをカメラからshadowDistanceまでの範囲に合わせる(デフォルトで無効)
+        virtual void setShadowFitToCamera(bool flag, float shadowDistance = 100.f);
+
+        //ジオメトリパスの同じバッチ内を手前から描く(デフォルトで有効)
+        //カメラが動くと並びが変わって記録し直しが増えるので、オーバードローが少ないシーンでは切ってもよい
+        virtual void setDepthSort(bool flag);
+
+        //バッチのSubCommandListを組み立てるスレッド数(0ならハードウェアのスレッド数, デフォルトは1)
+        //JobSystemが設定されていなければ自前で作る
+        //コマンドバッファの作成(createSubCommandBuffer)はこの設定によらず呼び出し側のスレッドで順番に行う
+        //(Cutlassはスレッドごとのコマンドプールを公開しておらず、作成もスレッドセーフではないため)
+        virtual void setRecordThreadCount(uint32_t count);
+
+        //SubCommandListの組み立てと視錐台カリングに使う, 所有はしない(nullptrで並列化しない)
+        virtual void setJobSystem(JobSystem* jobSystem);
+
     protected:
-        std::shared_ptr<Cutlass::Context> mContext;
+        std::shared_ptr<IRenderContext> mContext;
         std::vector<Cutlass::HWindow> mHWindows;
 
     private:
@@ -74,6 +132,7 @@ namespace Lynx
             Cutlass::HRenderPass renderPass;
         };
 
+        //GBuffer.hlsl, shadow.hlslのModelCBと同じ並び
         struct SceneData
         {
             glm::mat4 world;
@@ -133,39 +192,133 @@ namespace Lynx
             glm::mat4 boneTransform[MAX_BONE_NUM];
         };
 
+        struct SpriteInfo
+        {
+            std::weak_ptr<SpriteComponent> sprite;
+
+            glm::uvec2 size;
+
+            Cutlass::HBuffer VB;
+
+            Cutlass::HCommandBuffer spriteSubCB;
+        };
+
+        //同じ形状・パイプライン・マテリアルのRenderInfoは1つのサブコマンドバッファにまとめて記録する
+        struct BatchKey
+        {
+            std::vector<MeshRegistry::Handle> meshes;
+            uint32_t geometryPipeline;//PipelineCacheの通し番号
+            uint32_t shadowPipeline;//影を落とさないならUINT32_MAX
+            uint32_t material;//MaterialComponentのID
+
+            bool operator==(const BatchKey& another) const;
+        };
+
+        struct BatchKeyHash
+        {
+            size_t operator()(const BatchKey& key) const;
+        };
+
+        struct Batch
+        {
+            enum Pass
+            {
+                eShadowPass,
+                eGeometryPass,
+                ePassNum
+            };
+
+            BatchKey key;
+            Cutlass::HGraphicsPipeline shadowPipeline;
+            Cutlass::HGraphicsPipeline geometryPipeline;
+            std::weak_ptr<MaterialComponent> material;
+            uint32_t refCount;//0なら空き
+
+            std::vector<uint32_t> pending[ePassNum];//今回描くRenderInfo(mRenderInfosのインデックス)
+            std::vector<uint32_t> recorded[ePassNum];//記録済みのRenderInfo(serial)
+            Cutlass::HCommandBuffer subCB[ePassNum];
+            bool hasSubCB[ePassNum];
+            uint32_t drawCount[ePassNum];//subCBに記録したドローコール数
+            bool dirty;//メンバーが同じでも記録し直す
+        };
+
         struct RenderInfo
         {
             bool skeletal;
+            bool castShadow;
             bool receiveShadow;
             bool lighting;
             std::weak_ptr<MeshComponent> mesh;
             std::weak_ptr<SkeletalMeshComponent> skeletalMesh;
             std::weak_ptr<MaterialComponent> material;
 
-            std::vector<Cutlass::HBuffer> VBs;
-            std::vector<Cutlass::HBuffer> IBs;
+            std::vector<MeshRegistry::Handle> meshes;
 
             Cutlass::HBuffer sceneUB;
-            Cutlass::HBuffer boneUB;
             Cutlass::HBuffer shadowUB;
+            Cutlass::HBuffer boneUB;//スケルタルでなければmNoBoneUB
+
+            uint32_t batch;//mBatchesのインデックス
+            uint32_t serial;//RenderInfoごとに一意な番号
+
+            //最後に転送したときの入力のバージョン, 変化がなければ計算も転送もしない(0は未転送)
+            uint64_t sceneTransformVersion;
+            uint64_t sceneCameraVersion;
+            uint64_t shadowLightVersion;
+            uint64_t shadowTransformVersion;
+
+            //ボーンはバージョンを持たないので内容で比較する
+            bool boneCached;
+            std::unique_ptr<BoneData> boneCache;
+
+            //カリング用のワールド空間境界球
+            glm::vec3 worldCenter;
+            float worldRadius;
+            uint64_t boundsVersion;
+            bool inFrustum;
+            bool inShadowFrustum;
+        };
 
-            Cutlass::HGraphicsPipeline shadowPipeline;
-            Cutlass::HGraphicsPipeline geometryPipeline;
+        //RenderInfoをバッチに入れる, パイプラインもここで決まる
+        void assignBatch(RenderInfo& ri, const MeshComponent& mesh);
+        void releaseBatch(uint32_t index);
+
+        //pendingが記録済みと違えば古いサブコマンドバッファを破棄してtrue
+        bool updateBatch(Batch& batch, uint32_t pass);
 
-            Cutlass::HCommandBuffer shadowSubCB;
-            Cutlass::HCommandBuffer geometrySubCB;
+        //pendingの内容をsclに積んでドローコール数を返す, CPU側だけで完結するので複数スレッドから同時に呼んでよい
+        uint32_t recordBatch(const Batch& batch, uint32_t pass, Cutlass::SubCommandList& scl) const;
+
+        //変わったバッチのSubCommandListを組み立て直して(並列)、コマンドバッファを順番に作る
+        //作り直したものはmRecordJobsに残る
+        void recordBatches();
+
+        struct RecordJob
+        {
+            uint32_t batch;
+            uint32_t pass;
+            uint32_t drawCount;
+            std::unique_ptr<Cutlass::SubCommandList> list;
         };
 
-        struct SpriteInfo
+        struct DrawItem
         {
-            std::weak_ptr<SpriteComponent> sprite;
+            uint64_t key;
+            uint32_t index;//mRenderInfosのインデックス
+        };
 
-            glm::uvec2 size;
+        //RenderInfoが持つリソースを解放する
+        void destroyRenderInfo(RenderInfo& ri);
 
-            Cutlass::HBuffer VB;
+        void updateWorldBounds(RenderInfo& ri, const glm::mat4& world);
 
-            Cutlass::HCommandBuffer spriteSubCB;
-        };
+        //mRenderInfosのinFrustumを更新する
+        void cull(const glm::mat4& viewProj);
+
+        //cull()の後に呼ぶ, mRenderInfosのinShadowFrustumを更新する
+        void cullShadowCasters(LightComponent& light, const glm::mat4& lightViewProj);
+
+        void fitShadowToCamera(const CameraComponent& camera, const glm::vec3& lightDir, glm::mat4& view_out, glm::mat4& proj_out) const;
 
         const uint16_t mFrameCount;
         uint32_t mMaxWidth;
@@ -187,21 +340,36 @@ namespace Lynx
         Cutlass::Shader mSpriteFS;
 
 
+        std::unique_ptr<PipelineCache> mPipelineCache;
+        uint32_t mShadowPipelinePass;
+        uint32_t mGeometryPipelinePass;
+
+        std::unique_ptr<MeshRegistry> mMeshRegistry;
+
         Cutlass::HRenderPass mShadowPass;
         Cutlass::HTexture mShadowMap;
         Cutlass::HBuffer mShadowUB;
         //Cutlass::HGraphicsPipeline mShadowPipeline;
+
+        Cutlass::HBuffer mNoBoneUB;//スケルタルでないものはすべてこれを使う
     
         Cutlass::HRenderPass mLightingPass;
         Cutlass::HGraphicsPipeline mLightingPipeline;
 
         std::weak_ptr<CameraComponent> mCamera;
         Cutlass::HBuffer mCameraUB;
+        uint64_t mCameraVersion;//最後にmCameraUBへ転送したときのカメラのバージョン
         std::vector<std::weak_ptr<LightComponent>> mLights;
         Cutlass::HBuffer mLightUB;
+        std::vector<uint64_t> mLightVersions;//最後にmLightUB, mShadowUBへ転送したときのライトのバージョン
 
         //Cutlass::HGraphicsPipeline mGeometryPipeline;
         std::vector<RenderInfo> mRenderInfos;
+        uint32_t mNextSerial;
+
+        std::vector<Batch> mBatches;
+        std::vector<uint32_t> mFreeBatches;
+        std::unordered_map<BatchKey, uint32_t, BatchKeyHash> mBatchIndices;
 
         Cutlass::HRenderPass mSpritePass;
         std::vector<SpriteInfo> mSpriteInfos;
@@ -228,5 +396,36 @@ namespace Lynx
         Cutlass::HTexture mDebugSky;
 
         bool mSceneBuilded;
+
+        //前回プライマリコマンドバッファに積んだときの表示状態(mSpriteInfosと同じ並び)
+        std::vector<uint8_t> mSpriteVisibility;
+
+        std::chrono::steady_clock::time_point mRebuildWindowStart;
+        uint32_t mRebuildCountInWindow;
+        float mRebuildsPerSecond;
+
+        bool mFrustumCulling;
+        FrustumCuller mCuller;
+        std::vector<uint8_t> mCullResult;
+
+        bool mShadowCasterCulling;
+        bool mShadowFitToCamera;
+        float mShadowDistance;
+        uint64_t mShadowVersion;//最後にmShadowUBへ転送したときの入力
+
+        bool mDepthSort;
+        std::vector<DrawItem> mDrawLists[Batch::ePassNum];
+        std::vector<DrawItem> mDrawListScratch;
+        std::vector<uint32_t> mBatchOrders[Batch::ePassNum];//プライマリコマンドバッファに積んだバッチの順
+        std::vector<uint32_t> mBatchOrderScratch;
+
+        uint32_t mRecordThreadCount;
+        const uint32_t mRecordChunkSize;//1スレッドあたりの最低限のバッチ数
+        std::vector<RecordJob> mRecordJobs;
+
+        JobSystem* mJobSystem;
+        std::unique_ptr<JobSystem> mOwnedJobSystem;
+
+        Statistics mStatistics;
     };
 };
\ No newline at end of file
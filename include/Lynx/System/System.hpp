@@ -2,6 +2,9 @@
 
 #include <memory>
 
+#include "AnimationSystem.hpp"
+#include "FrameClock.hpp"
+#include "JobSystem.hpp"
 #include "Loader.hpp"
 #include "Renderer.hpp"
 #include "Input.hpp"
@@ -12,6 +15,10 @@ namespace Lynx
     {
     public:
 
+        //他のシステムが使うので最後に破棄されるよう先頭に置く
+        std::unique_ptr<JobSystem> jobSystem;
+        std::unique_ptr<FrameClock> frameClock;
+        std::unique_ptr<AnimationSystem> animationSystem;
         std::unique_ptr<Loader> loader;
         std::unique_ptr<Renderer> renderer;
         std::unique_ptr<Input> input;
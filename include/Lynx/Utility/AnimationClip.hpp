@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Lynx
+{
+    //単位クォータニオンを成分ごとに16bitの固定小数点にしたもの
+    struct QuantizedQuat
+    {
+        int16_t x, y, z, w;
+    };
+
+    //ノードごとのローカルの姿勢(スケルトンのノードと同じ並び)
+    //ブレンドは行列ではなくこの形で行う
+    struct AnimationPose
+    {
+        void resize(size_t nodeNum);
+        size_t size() const;
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+    };
+
+    //dst = mix(dst, src, weight * mask[i]), maskがnullptrなら全ノード同じ重み
+    void blendPose(AnimationPose& dst, const AnimationPose& src, float weight, const float* mask = nullptr);
+
+    //srcのreferenceからの差分をweight * mask[i]だけdstに足す(加算レイヤー)
+    void addPose(AnimationPose& dst, const AnimationPose& src, const AnimationPose& reference, float weight, const float* mask = nullptr);
+
+    //キーを間引くときの許容誤差, 0なら間引かない(回転の量子化だけ)
+    struct AnimationCompression
+    {
+        float positionTolerance = 0;
+        float rotationTolerance = 0;//ラジアン
+        float scaleTolerance = 0;
+    };
+
+    //エンジン内部のアニメーションクリップ
+    //時刻は秒のfloat, 回転は量子化して、全チャンネルのキーを種類ごとに1本の配列に詰めて持つ
+    //読み込み元(aiScene)には依存しない
+    struct AnimationClip
+    {
+        struct Track
+        {
+            uint32_t begin;
+            uint32_t count;//0ならキーなし
+        };
+
+        struct Channel
+        {
+            Track position;
+            Track rotation;
+            Track scale;
+        };
+
+        AnimationClip();
+
+        //許容誤差内で前後のキーの補間で再現できるキーは捨てて追加する
+        //timesは昇順の秒
+        Track addPositions(const float* times, const glm::vec3* values, uint32_t count, float tolerance);
+        Track addRotations(const float* times, const glm::quat* values, uint32_t count, float tolerance);
+        Track addScales(const float* times, const glm::vec3* values, uint32_t count, float tolerance);
+
+        //cursorは前回のキー(再生位置ごとに持つ), 順再生なら続きから探すだけで済む
+        glm::vec3 samplePosition(const Track& track, float time, uint32_t& cursor) const;
+        glm::quat sampleRotation(const Track& track, float time, uint32_t& cursor) const;
+        glm::vec3 sampleScale(const Track& track, float time, uint32_t& cursor) const;
+
+        //全ノードの姿勢をoutに書く, キーのないノードはbindPoseのまま
+        //cursorsはノードごとに3つ
+        void samplePose(float time, const AnimationPose& bindPose, uint32_t* cursors, AnimationPose& out) const;
+
+        //キーとチャンネルに使っているバイト数
+        size_t getMemorySize() const;
+
+        static QuantizedQuat quantize(const glm::quat& q);
+        static glm::quat dequantize(const QuantizedQuat& q);
+
+        float duration;//秒
+        std::vector<Channel> channels;//スケルトンのノードと同じ並び, キーのないノードはcountが0
+
+        std::vector<float> positionTimes;
+        std::vector<glm::vec3> positions;
+        std::vector<float> rotationTimes;
+        std::vector<QuantizedQuat> rotations;
+        std::vector<float> scaleTimes;
+        std::vector<glm::vec3> scales;
+    };
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace Lynx
+{
+    //64bitのkeyメンバを持つ要素をLSD基数ソートする(安定)
+    //scratchは作業用, 使い回せば毎回の確保を省ける
+    //全要素で同じ値の桁は飛ばすので、上位ビットが空いているキーでも無駄がない
+    template<typename T>
+    void radixSort(std::vector<T>& items, std::vector<T>& scratch)
+    {
+        constexpr size_t radixBits = 8;
+        constexpr size_t radix = 1 << radixBits;
+        constexpr size_t passNum = 64 / radixBits;
+
+        if(items.size() < 2)
+            return;
+
+        scratch.resize(items.size());
+
+        //全桁のヒストグラムを1回の走査で作る
+        size_t counts[passNum][radix] = {};
+        for(const auto& item : items)
+            for(size_t pass = 0; pass < passNum; ++pass)
+                ++counts[pass][(item.key >> (pass * radixBits)) & (radix - 1)];
+
+        std::vector<T>* src = &items;
+        std::vector<T>* dst = &scratch;
+        for(size_t pass = 0; pass < passNum; ++pass)
+        {
+            auto& count = counts[pass];
+
+            //この桁が全員同じなら並びは変わらない
+            const size_t digit = ((*src)[0].key >> (pass * radixBits)) & (radix - 1);
+            if(count[digit] == items.size())
+                continue;
+
+            size_t offset = 0;
+            for(size_t i = 0; i < radix; ++i)
+            {
+                const size_t tmp = count[i];
+                count[i] = offset;
+                offset += tmp;
+            }
+
+            for(const auto& item : *src)
+                (*dst)[count[(item.key >> (pass * radixBits)) & (radix - 1)]++] = item;
+
+            std::swap(src, dst);
+        }
+
+        if(src != &items)
+            items.swap(scratch);
+    }
+}
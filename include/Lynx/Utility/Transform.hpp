@@ -1,6 +1,6 @@
 #pragma once
 
-#include <chrono>
+#include <cstdint>
 
 #include <glm/glm.hpp>
 
@@ -12,6 +12,8 @@ namespace Lynx
         Transform();
         virtual ~Transform();
 
+        //setPos(), setScale(), setRotation()はその値に置き直す(補間せずに飛ぶ)
+        //なめらかに動かすならsetVel()などで動かす
         void setPos(const glm::vec3& pos);
         const glm::vec3& getPos() const;
         
@@ -38,11 +40,35 @@ namespace Lynx
         void setRotAcc(float angleAcc);
         const float getRotAcc() const;
 
+        //親のワールド行列 * 自分の行列がワールド行列になる, nullptrで外す
+        //getPos()などは親から見た値のまま, 親は子より先に破棄しないこと(先に消すなら子を外す)
+        void setParent(Transform* parent);
+        Transform* getParent() const;
+
+        //親を含まない自分の行列
+        const glm::mat4& getLocalMatrix() const;
+
+        //親があれば呼ばれたときに合わせ直す
         const glm::mat4& getWorldMatrix();
 
+        //ワールド行列が変わるたびに更新される(親が動いたときも)
+        uint64_t getVersion() const;
+
+        //前回と今回のupdate()の間をalpha(0~1)で補間したワールド行列(固定ステップの描画用)
+        //親があれば親も同じalphaで補間したものと合わせる
+        //alphaが1か, 前回から動いていなければgetWorldMatrix()と同じ
+        const glm::mat4& getRenderMatrix(float alpha);
+
+        //直前のgetRenderMatrix()の結果が変わるたびに更新される
+        uint64_t getRenderVersion() const;
+
+        //deltaTimeはFrameClock::getCurrent()から読む
         virtual void update();
         
     private:
+        //親を含まない補間された行列
+        const glm::mat4& getLocalRenderMatrix(float alpha);
+
         glm::vec3 mPos;
         glm::vec3 mVel;
         glm::vec3 mAcc;
@@ -54,8 +80,27 @@ namespace Lynx
         float mRotVel;
         float mRotAcc;
 
-        glm::mat4 mWorld;
+        glm::mat4 mLocal;
+        uint64_t mVersion;//mLocalが変わるたびに更新される
+        bool mDirty;//setterが呼ばれた
+
+        //補間用, 前回と今回のupdate()を抜けたときの値
+        glm::vec3 mPrevPos, mTickPos;
+        glm::vec3 mPrevScale, mTickScale;
+        float mPrevRotAngle, mTickRotAngle;
+
+        glm::mat4 mLocalRender;
+        float mRenderAlpha;
+        uint64_t mRenderSource;//mLocalRenderを作ったときのmVersion
+        uint64_t mLocalRenderVersion;
+
+        Transform* mParent;
+        glm::mat4 mWorld;//親があるときだけ使う
+        uint64_t mWorldVersion;//mWorldを作ったときのgetVersion()
 
-        std::chrono::high_resolution_clock::time_point mPrev;
+        glm::mat4 mRender;//親があるときだけ使う
+        uint64_t mRenderLocalSource;//mRenderを作ったときのmLocalRenderVersion
+        uint64_t mRenderParentSource;//mRenderを作ったときの親のgetRenderVersion()
+        uint64_t mRenderVersion;
     };
 };
\ No newline at end of file
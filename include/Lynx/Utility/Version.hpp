@@ -0,0 +1,15 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Lynx
+{
+    //変更検出用の通し番号を発行する
+    //全体で一意なので、コピーされたオブジェクトや別のオブジェクトと比べても衝突しない(0は未発行)
+    inline uint64_t issueVersion()
+    {
+        static std::atomic<uint64_t> generator(1);
+        return generator.fetch_add(1, std::memory_order_relaxed);
+    }
+}
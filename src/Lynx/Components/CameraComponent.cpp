@@ -1,9 +1,11 @@
 #include <Lynx/Components/CameraComponent.hpp>
+#include <Lynx/Utility/Version.hpp>
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 
 #include <iostream>//debug
+#include <algorithm>
 
 namespace Lynx
 {
@@ -16,6 +18,8 @@ namespace Lynx
         mAspect = 640.f / 480.f;//適当、設定すべきである
         mNear = 0.1f;
         mFar = static_cast<float>(1e6);
+        mParamVersion = issueVersion();
+        mVersion = 0;
     }
 
     void CameraComponent::setEnable(bool flag)
@@ -36,6 +40,7 @@ namespace Lynx
     void CameraComponent::setTransform(const Transform& transform)
     {
         mTransform = transform;
+        mParamVersion = issueVersion();
     }
 
     Transform& CameraComponent::getTransform()
@@ -52,11 +57,13 @@ namespace Lynx
     {
         mLookPos = lookPos;
         mUp = up;
+        mParamVersion = issueVersion();
     }
 
     void CameraComponent::setLookAt(const glm::vec3& lookPos)
     {
         mLookPos = lookPos;
+        mParamVersion = issueVersion();
     }
 
     const glm::vec3& CameraComponent::getLookAt() const
@@ -67,6 +74,7 @@ namespace Lynx
     void CameraComponent::setUpDir(const glm::vec3& up)
     {
         mUp = up;
+        mParamVersion = issueVersion();
     }
 
     const glm::vec3& CameraComponent::getUpDir() const
@@ -80,11 +88,13 @@ namespace Lynx
         setAspectAuto(width, height);
         mNear = near;
         mFar = far;
+        mParamVersion = issueVersion();
     }
 
     void CameraComponent::setFovY(float fovAngle)
     {
         mFovY = fovAngle;
+        mParamVersion = issueVersion();
     }
 
     const float CameraComponent::getFovY() const
@@ -95,11 +105,13 @@ namespace Lynx
     void CameraComponent::setAspect(float aspect)
     {
         mAspect = aspect;
+        mParamVersion = issueVersion();
     }
 
     void CameraComponent::setAspectAuto(uint32_t screenWidth, uint32_t screenHeight)
     {
         mAspect = 1.f * screenWidth / screenHeight;
+        mParamVersion = issueVersion();
     }
 
     const float CameraComponent::getAspect() const
@@ -111,6 +123,7 @@ namespace Lynx
     {
         mNear = near;
         mFar = far;
+        mParamVersion = issueVersion();
     }
 
     const float CameraComponent::getNear() const
@@ -133,9 +146,21 @@ namespace Lynx
         return mProjection;
     }
 
+    uint64_t CameraComponent::getVersion() const
+    {
+        return mVersion;
+    }
+
     void CameraComponent::update()
     {
         mTransform.update();
+
+        //位置もパラメータも変わっていなければ計算し直さない
+        const uint64_t version = std::max(mParamVersion, mTransform.getVersion());
+        if(version == mVersion)
+            return;
+        mVersion = version;
+
         mView = glm::lookAtRH(mTransform.getPos(), mLookPos, mUp);
         mProjection = glm::perspective(mFovY, mAspect, mNear, mFar);
         mProjection[1][1] *= -1;
@@ -0,0 +1,31 @@
+#include <Lynx/Components/ComponentStorage.hpp>
+
+namespace Lynx
+{
+    void ComponentStorage::updateAll()
+    {
+        //更新中に新しい型のプールが増えることもあるので、1つずつロックして取り出す
+        for(size_t i = 0;; ++i)
+        {
+            std::shared_ptr<IComponentPool> pool;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if(i >= mPools.size())
+                    break;
+                pool = mPools[i];
+            }
+
+            pool->updateAll();
+        }
+    }
+
+    size_t ComponentStorage::size() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        size_t size = 0;
+        for(const auto& pool : mPools)
+            size += pool->size();
+
+        return size;
+    }
+}
@@ -1,9 +1,13 @@
 #include <Lynx/Components/LightComponent.hpp>
+#include <Lynx/Utility/Version.hpp>
+
+#include <algorithm>
 
 namespace Lynx
 {
     LightComponent::LightComponent()
     : mEnable(true)
+    , mParamVersion(issueVersion())
     {
         //とりあえず
         // DirectionalLightParam data;
@@ -19,6 +23,7 @@ namespace Lynx
         mColor = color;
         mRange = range;
         mDirection = glm::vec3(0);
+        mParamVersion = issueVersion();
     }
 
     void LightComponent::setAsDirectionalLight(const glm::vec4& color, const glm::vec3& direction)
@@ -26,6 +31,7 @@ namespace Lynx
         mType = LightType::eDirectionalLight;
         mColor = color;
         mDirection = glm::normalize(direction);
+        mParamVersion = issueVersion();
     }
 
     const LightComponent::LightType LightComponent::getType() const
@@ -48,14 +54,21 @@ namespace Lynx
         return mRange;
     }
 
+    uint64_t LightComponent::getVersion() const
+    {
+        return std::max(mParamVersion, mTransform.getVersion());
+    }
+
     void LightComponent::setEnable(bool flag)
     {
         mEnable = flag;
+        mParamVersion = issueVersion();
     }
 
     void LightComponent::setEnable()
     {
         mEnable = !mEnable;
+        mParamVersion = issueVersion();
     }
 
     const bool LightComponent::getEnable() const
@@ -66,6 +79,7 @@ namespace Lynx
     void LightComponent::setTransform(const Transform& transform)
     {
         mTransform = transform;
+        mParamVersion = issueVersion();
     }
 
     Transform& LightComponent::getTransform()
@@ -3,6 +3,7 @@
 #include <Lynx/Components/MaterialComponent.hpp>
 
 #include <iostream>
+#include <algorithm>
 
 namespace Lynx
 {
@@ -12,6 +13,7 @@ namespace Lynx
     {
         mTopology = Cutlass::Topology::eTriangleList;
         mRasterizerState = Cutlass::RasterizerState(Cutlass::PolygonMode::eFill, Cutlass::CullMode::eBack, Cutlass::FrontFace::eCounterClockwise);
+        mBounds.compute({});
     }
 
     MeshComponent::~MeshComponent()
@@ -84,6 +86,60 @@ namespace Lynx
         return mMeshes;
     }
 
+    const MeshComponent::Bounds& MeshComponent::getBounds() const
+    {
+        return mBounds;
+    }
+
+    void MeshComponent::Bounds::compute(const std::vector<Vertex>& vertices)
+    {
+        if(vertices.empty())
+        {
+            min = max = center = glm::vec3(0);
+            radius = 0;
+            return;
+        }
+
+        min = max = vertices[0].pos;
+        for(const auto& v : vertices)
+        {
+            min = glm::min(min, v.pos);
+            max = glm::max(max, v.pos);
+        }
+
+        center = (min + max) * 0.5f;
+        radius = 0;
+        for(const auto& v : vertices)
+            radius = std::max(radius, glm::length(v.pos - center));
+    }
+
+    void MeshComponent::Bounds::merge(const Bounds& another)
+    {
+        min = glm::min(min, another.min);
+        max = glm::max(max, another.max);
+        
+        //AABBの中心から両方の球を包む
+        const glm::vec3 c = (min + max) * 0.5f;
+        radius = std::max(glm::length(center - c) + radius, glm::length(another.center - c) + another.radius);
+        center = c;
+    }
+
+    void MeshComponent::computeBounds()
+    {
+        for(auto& mesh : mMeshes)
+            mesh.bounds.compute(mesh.vertices);
+
+        if(mMeshes.empty())
+        {
+            mBounds.compute({});
+            return;
+        }
+
+        mBounds = mMeshes[0].bounds;
+        for(size_t i = 1; i < mMeshes.size(); ++i)
+            mBounds.merge(mMeshes[i].bounds);
+    }
+
     void MeshComponent::update()
     {
         //update
@@ -119,12 +175,16 @@ namespace Lynx
         auto& mesh = mMeshes.back();
         mesh.vertices = vertices;
         mesh.indices = indices;
+
+        computeBounds();
     }
 
     void MeshComponent::create(const std::vector<Mesh>& meshes)
     {
         mVisible = mEnabled = true;
         mMeshes = meshes;
+
+        computeBounds();
     }
 
     void MeshComponent::createCube(const double& edgeLength)
@@ -196,6 +256,8 @@ namespace Lynx
             20, 22, 21, 21, 22, 23, // bottom
         };
 
+        computeBounds();
+
     }
 
     void MeshComponent::createPlane(const double& xSize, const double& zSize)
@@ -236,6 +298,8 @@ namespace Lynx
             0, 2, 1, 1, 2, 3
         };
 
+        computeBounds();
+
         // auto&& context = getContext();
         // {
         //     Cutlass::BufferInfo bi;
@@ -1,13 +1,23 @@
 #include <Lynx/Components/SkeletalMeshComponent.hpp>
+#include <Lynx/System/FrameClock.hpp>
+#include <Lynx/System/AnimationSystem.hpp>
+
+#include <assimp/scene.h>
 
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <unordered_map>
 
 namespace Lynx
 {
@@ -44,179 +54,251 @@ namespace Lynx
         return to;
     }
 
-    void SkeletalMeshComponent::Skeleton::update(float second, size_t animationIndex)
+    //せん断のない行列をtranslate * rotate * scaleに分ける
+    inline void decompose(const glm::mat4& m, glm::vec3& position, glm::quat& rotation, glm::vec3& scale)
+    {
+        glm::vec3 axes[] = {glm::vec3(m[0]), glm::vec3(m[1]), glm::vec3(m[2])};
+        scale = glm::vec3(glm::length(axes[0]), glm::length(axes[1]), glm::length(axes[2]));
+        //鏡映はx軸の反転として持つ
+        if(glm::dot(glm::cross(axes[0], axes[1]), axes[2]) < 0)
+            scale.x = -scale.x;
+
+        glm::mat4 rotationMatrix(1.f);
+        const std::equal_to<float> equal;
+        for(int i = 0; i < 3; ++i)
+            rotationMatrix[i] = glm::vec4(!equal(scale[i], 0) ? axes[i] / scale[i] : axes[i], 0);
+
+        rotation = glm::normalize(glm::quat_cast(rotationMatrix));
+        position = glm::vec3(m[3]);
+    }
+
+    void SkeletalMeshComponent::Skeleton::build(const aiScene& scene, const AnimationCompression& compression)
     {
-        if(animationIndex >= scene->mNumAnimations)
+        assert(scene.mRootNode);
+
+        mNodes.clear();
+        std::vector<const aiNode*> sources;
+        flattenNode(scene.mRootNode, UINT32_MAX, sources);
+
+        //チャンネルはノード名で対応づける, 文字列を比べるのはここだけ
+        std::unordered_map<std::string, uint32_t> nodeIndices;
+        nodeIndices.reserve(sources.size());
+        for(size_t i = 0; i < sources.size(); ++i)
+            nodeIndices.emplace(sources[i]->mName.C_Str(), static_cast<uint32_t>(i));
+
+        auto animations = std::make_shared<std::vector<AnimationClip>>(scene.mNumAnimations);
+        std::vector<float> times;
+        std::vector<glm::vec3> vectors;
+        std::vector<glm::quat> quats;
+        for(size_t a = 0; a < scene.mNumAnimations; ++a)
         {
-            assert(!"invalid animation index!");
-            return;
+            const aiAnimation* pAnimation = scene.mAnimations[a];
+            auto& clip = (*animations)[a];
+
+            //時刻はtickから秒にする
+            double ticksPerSecond = pAnimation->mTicksPerSecond;
+            if(std::equal_to<double>()(ticksPerSecond, 0))
+            {
+                assert("zero update time!");
+                ticksPerSecond = 25.;//?
+            }
+            clip.duration = static_cast<float>(pAnimation->mDuration / ticksPerSecond);
+
+            AnimationClip::Channel none;
+            none.position = none.rotation = none.scale = AnimationClip::Track{0, 0};
+            clip.channels.assign(mNodes.size(), none);
+
+            for(size_t c = 0; c < pAnimation->mNumChannels; ++c)
+            {
+                const aiNodeAnim* pAnimationNode = pAnimation->mChannels[c];
+                const auto& itr = nodeIndices.find(pAnimationNode->mNodeName.C_Str());
+                //同じノードに複数あれば最初のものを使う(以前の線形探索と同じ)
+                if(itr == nodeIndices.end() || clip.channels[itr->second].position.count > 0)
+                    continue;
+
+                assert(pAnimationNode->mNumScalingKeys  >= 1);
+                assert(pAnimationNode->mNumRotationKeys >= 1);
+                assert(pAnimationNode->mNumPositionKeys >= 1);
+
+                auto& channel = clip.channels[itr->second];
+
+                times.clear();
+                vectors.clear();
+                for(size_t k = 0; k < pAnimationNode->mNumPositionKeys; ++k)
+                {
+                    times.emplace_back(static_cast<float>(pAnimationNode->mPositionKeys[k].mTime / ticksPerSecond));
+                    vectors.emplace_back(convertVec3(pAnimationNode->mPositionKeys[k].mValue));
+                }
+                channel.position = clip.addPositions(times.data(), vectors.data(), static_cast<uint32_t>(times.size()), compression.positionTolerance);
+
+                times.clear();
+                for(size_t k = 0; k < pAnimationNode->mNumRotationKeys; ++k)
+                {
+                    times.emplace_back(static_cast<float>(pAnimationNode->mRotationKeys[k].mTime / ticksPerSecond));
+                    quats.emplace_back(convertQuat(pAnimationNode->mRotationKeys[k].mValue));
+                }
+                channel.rotation = clip.addRotations(times.data(), quats.data(), static_cast<uint32_t>(times.size()), compression.rotationTolerance);
+                quats.clear();
+
+                times.clear();
+                vectors.clear();
+                for(size_t k = 0; k < pAnimationNode->mNumScalingKeys; ++k)
+                {
+                    times.emplace_back(static_cast<float>(pAnimationNode->mScalingKeys[k].mTime / ticksPerSecond));
+                    vectors.emplace_back(convertVec3(pAnimationNode->mScalingKeys[k].mValue));
+                }
+                channel.scale = clip.addScales(times.data(), vectors.data(), static_cast<uint32_t>(times.size()), compression.scaleTolerance);
+            }
+
+            //キーの配列は以後増えないので余分を返す
+            clip.positionTimes.shrink_to_fit();
+            clip.positions.shrink_to_fit();
+            clip.rotationTimes.shrink_to_fit();
+            clip.rotations.shrink_to_fit();
+            clip.scaleTimes.shrink_to_fit();
+            clip.scales.shrink_to_fit();
         }
+        mAnimations = std::move(animations);
 
-        float updateTime = scene->mAnimations[animationIndex]->mTicksPerSecond;
-        if(updateTime == 0)
+        for(size_t i = 0; i < mNodes.size(); ++i)
         {
-            assert("zero update time!");
-            updateTime = 25.f;//?
+            mNodes[i].animated = false;
+            for(const auto& clip : *mAnimations)
+                mNodes[i].animated |= clip.channels[i].position.count > 0;
         }
 
-        traverseNode(fmod(second * updateTime, scene->mAnimations[animationIndex]->mDuration), animationIndex, scene->mRootNode, glm::mat4(1.f));
-    }
-
-    inline size_t findScale(float time, aiNodeAnim* pAnimationNode)
-    {
-        if(pAnimationNode->mNumScalingKeys == 1)
-            return 0;
-        
+        //ブレンドはTRSで行うので、キーのないノードの姿勢も分解しておく
+        mBindPose.resize(mNodes.size());
+        for(size_t i = 0; i < mNodes.size(); ++i)
+            decompose(mNodes[i].transform, mBindPose.positions[i], mBindPose.rotations[i], mBindPose.scales[i]);
 
-        for(size_t i = 0; i < pAnimationNode->mNumScalingKeys - 1; ++i)
-            if(time < static_cast<float>(pAnimationNode->mScalingKeys[i + 1].mTime))
-                return i;
+        mNodeNames.clear();
+        mNodeNames.reserve(sources.size());
+        for(const auto& source : sources)
+            mNodeNames.emplace_back(source->mName.C_Str());
 
-        assert(!"failed to find scale index!");
-        return 0;
+        mPose.resize(mNodes.size());
+        mGlobals.resize(mNodes.size());
+        mCursors.assign(mNodes.size() * 3, 0);
+        mCursorAnimation = SIZE_MAX;
     }
 
-    inline size_t findRotation(float time, aiNodeAnim* pAnimationNode)
+    void SkeletalMeshComponent::Skeleton::flattenNode(const aiNode* node, uint32_t parent, std::vector<const aiNode*>& sources)
     {
-        if(pAnimationNode->mNumRotationKeys == 1)
-            return 0;
+        const uint32_t index = static_cast<uint32_t>(mNodes.size());
 
-        for(size_t i = 0; i < pAnimationNode->mNumRotationKeys - 1; ++i)
-            if(time < static_cast<float>(pAnimationNode->mRotationKeys[i + 1].mTime))
-                return i;
+        auto& dst = mNodes.emplace_back();
+        dst.transform = convert4x4(node->mTransformation);
+        dst.parent = parent;
+        dst.animated = false;
 
-        assert(!"failed to find rotation index!");
-        return 0;
-    }
+        const auto& itr = boneMap.find(node->mName.C_Str());
+        dst.bone = itr == boneMap.end() ? UINT32_MAX : static_cast<uint32_t>(itr->second);
 
-    inline size_t findPosition(float time, aiNodeAnim* pAnimationNode)
-    {
-        if(pAnimationNode->mNumPositionKeys == 1)
-            return 0;
+        sources.emplace_back(node);
 
-        for(size_t i = 0; i < pAnimationNode->mNumPositionKeys - 1; ++i)
-            if(time < static_cast<float>(pAnimationNode->mPositionKeys[i + 1].mTime))
-                return i;
-        
-        assert(!"failed to find position index!");
-        return 0;
+        for(size_t i = 0; i < node->mNumChildren; ++i)
+            flattenNode(node->mChildren[i], index, sources);
     }
 
-    void SkeletalMeshComponent::Skeleton::traverseNode(float timeInAnim, size_t animationIndex, const aiNode* node, glm::mat4 parentTransform)
+    void SkeletalMeshComponent::Skeleton::update(float second, size_t animationIndex)
     {
-        //std::cerr << "\n\n\nprev parentTransform\n" << glm::to_string(parentTransform) << "\n";
-
-        std::string nodeName = std::string(node->mName.C_Str());
-
-        const aiAnimation* pAnimation = scene->mAnimations[animationIndex];
+        //クリップが変わったらカーソルは先頭から
+        if(mCursorAnimation != animationIndex)
+        {
+            std::fill(mCursors.begin(), mCursors.end(), 0);
+            mCursorAnimation = animationIndex;
+        }
 
-        glm::mat4 transform = convert4x4(node->mTransformation);
+        samplePose(animationIndex, second, mCursors.data(), mPose);
+        applyPose(mPose);
+    }
 
-        // if(nodeName == "Z_UP")
-        // {
-        //     transform = glm::mat4(1.f);
-        // }
+    void SkeletalMeshComponent::Skeleton::samplePose(size_t animationIndex, float second, uint32_t* cursors, AnimationPose& out) const
+    {
+        //build()されていない
+        assert(mAnimations && !mNodes.empty());
 
-        //std::cerr << "original transform\n" << glm::to_string(transform) << "\n";
+        out.resize(mNodes.size());
+        if(animationIndex >= mAnimations->size())
+        {
+            assert(!"invalid animation index!");
+            out = mBindPose;
+            return;
+        }
 
-        aiNodeAnim* pAnimationNode = nullptr;
+        const auto& clip = (*mAnimations)[animationIndex];
+        const float timeInAnim = clip.duration > 0 ? std::fmod(second, clip.duration) : 0;
+        clip.samplePose(timeInAnim, mBindPose, cursors, out);
+    }
 
-        //find animation node
-        for (size_t i = 0; i < pAnimation->mNumChannels; ++i) 
-            if (std::string(pAnimation->mChannels[i]->mNodeName.data) == nodeName) 
-            {
-                pAnimationNode = pAnimation->mChannels[i];
-                break;
-            }
-        
+    void SkeletalMeshComponent::Skeleton::applyPose(const AnimationPose& pose)
+    {
+        assert(pose.size() == mNodes.size());
 
-        if(pAnimationNode)
+        //親が先に並んでいるので前から流すだけでよい
+        const glm::mat4 axisInverse = defaultAxis * mGlobalInverse;
+        for(size_t i = 0; i < mNodes.size(); ++i)
         {
-            //check
-            //std::cerr << pAnimationNode->mNumScalingKeys << "\n";
-            //std::cerr << pAnimationNode->mNumRotationKeys << "\n";
-            //std::cerr << pAnimationNode->mNumPositionKeys << "\n";
-            assert(pAnimationNode->mNumScalingKeys  >= 1);
-            assert(pAnimationNode->mNumRotationKeys >= 1);
-            assert(pAnimationNode->mNumPositionKeys >= 1);
-
-            //find right time scaling key
-            size_t scaleIndex 	 = findScale(timeInAnim, pAnimationNode);
-            size_t rotationIndex = findRotation(timeInAnim, pAnimationNode);
-            size_t positionIndex = findPosition(timeInAnim, pAnimationNode);
-
-            //std::cerr << "keys : \n";
-            // std::cerr << scaleIndex << "\n";
-            // std::cerr << rotationIndex << "\n";
-            // std::cerr << positionIndex << "\n\n";
-
-            glm::mat4 scale, rotation, translate;
-
-            //scale
-            if(pAnimationNode->mNumScalingKeys == 1)
-                scale = glm::scale(glm::mat4(1.f), convertVec3(pAnimationNode->mScalingKeys[scaleIndex].mValue));
-            else
-            {
-                glm::vec3&& start = convertVec3(pAnimationNode->mScalingKeys[scaleIndex].mValue);
-                glm::vec3&& end   = convertVec3(pAnimationNode->mScalingKeys[scaleIndex + 1].mValue);
-                float dt = pAnimationNode->mScalingKeys[scaleIndex + 1].mTime - pAnimationNode->mScalingKeys[scaleIndex].mTime;
+            const auto& node = mNodes[i];
+            const glm::mat4 local = node.animated ? glm::translate(glm::mat4(1.f), pose.positions[i]) * glm::toMat4(pose.rotations[i]) * glm::scale(glm::mat4(1.f), pose.scales[i]) : node.transform;
+            mGlobals[i] = node.parent == UINT32_MAX ? local : mGlobals[node.parent] * local;
 
-                glm::vec3&& lerped = glm::mix(start, end, (timeInAnim - static_cast<float>(pAnimationNode->mScalingKeys[scaleIndex].mTime)) / dt);
-                scale = glm::scale(glm::mat4(1.f), lerped);
-                //std::cerr << "scale\n" << glm::to_string(scale) << "\n";
-            }
+            if(node.bone != UINT32_MAX)
+                bones[node.bone].transform = axisInverse * mGlobals[i] * bones[node.bone].offset;
+        }
+    }
 
-            //rotation
-            {
-                glm::quat&& start = convertQuat(pAnimationNode->mRotationKeys[rotationIndex].mValue);
-                glm::quat&& end   = convertQuat(pAnimationNode->mRotationKeys[rotationIndex + 1].mValue);
-                float dt = pAnimationNode->mRotationKeys[rotationIndex + 1].mTime - pAnimationNode->mRotationKeys[rotationIndex].mTime;
-                
-                glm::quat&& slerped = glm::mix(start, end, (timeInAnim - static_cast<float>(pAnimationNode->mRotationKeys[rotationIndex].mTime)) / dt);
-                rotation = glm::toMat4(glm::normalize(slerped));
-                //std::cerr << "rotation\n" << glm::to_string(rotation) << "\n";
-            }
+    size_t SkeletalMeshComponent::Skeleton::getAnimationNum() const
+    {
+        return mAnimations ? mAnimations->size() : 0;
+    }
 
-            //position(translate)
-            {
-                glm::vec3&& start = convertVec3(pAnimationNode->mPositionKeys[positionIndex].mValue);
-                glm::vec3&& end   = convertVec3(pAnimationNode->mPositionKeys[positionIndex + 1].mValue);
-                float dt = pAnimationNode->mPositionKeys[positionIndex + 1].mTime - pAnimationNode->mPositionKeys[positionIndex].mTime;
+    const AnimationClip& SkeletalMeshComponent::Skeleton::getAnimation(size_t animationIndex) const
+    {
+        assert(animationIndex < getAnimationNum());
+        return (*mAnimations)[animationIndex];
+    }
 
-                glm::vec3&& lerped =  glm::mix(start, end, (timeInAnim - static_cast<float>(pAnimationNode->mPositionKeys[positionIndex].mTime)) / dt);
-                translate = glm::translate(glm::mat4(1.f), lerped);
-                //std::cerr << "translate\n" << glm::to_string(translate) << "\n";
-            }
+    size_t SkeletalMeshComponent::Skeleton::getNodeNum() const
+    {
+        return mNodes.size();
+    }
 
-            transform = translate * rotation * scale;
-        }
+    size_t SkeletalMeshComponent::Skeleton::getCursorNum() const
+    {
+        return mNodes.size() * 3;
+    }
 
-        glm::mat4 globalTransform = parentTransform * transform;
+    const AnimationPose& SkeletalMeshComponent::Skeleton::getBindPose() const
+    {
+        return mBindPose;
+    }
 
-        if(boneMap.count(nodeName) > 0)
-        {
-            size_t boneIndex = boneMap[nodeName];
-            // std::cerr << "boneIndex " << boneIndex << "\n";
-            // std::cerr << "transform\n" << glm::to_string(transform) << "\n";
-            // std::cerr << "parentTransform\n" << glm::to_string(parentTransform) << "\n";
-            // std::cerr << "globalTransform\n" << glm::to_string(globalTransform) << "\n";
-            // std::cerr << "boneOffset\n" << glm::to_string(bones[boneIndex].offset) << "\n";
-            bones[boneIndex].transform = defaultAxis * mGlobalInverse * globalTransform * bones[boneIndex].offset;
-            //std::cerr << "boneTransform\n" << glm::to_string(bones[boneIndex].transform) << "\n";
-        }
+    std::vector<float> SkeletalMeshComponent::Skeleton::createMask(const std::string& nodeName) const
+    {
+        std::vector<float> mask(mNodes.size(), 0);
+        //親が先に並んでいるので、親が入っていれば子も入る
+        for(size_t i = 0; i < mNodes.size(); ++i)
+            if(mNodeNames[i] == nodeName || (mNodes[i].parent != UINT32_MAX && mask[mNodes[i].parent] > 0))
+                mask[i] = 1.f;
 
-        for(size_t i = 0; i < node->mNumChildren; ++i)
-            traverseNode(timeInAnim, animationIndex, node->mChildren[i], globalTransform);
+        return mask;
     }
 
     SkeletalMeshComponent::SkeletalMeshComponent()
     : mTimeScale(1.f)
+    , mFadeTime(0)
+    , mFadeDuration(0)
+    , mSubmitted(false)
     {
 
     }
 
     SkeletalMeshComponent::~SkeletalMeshComponent()
     {
+        if(auto animationSystem = AnimationSystem::getCurrent())
+            animationSystem->cancel(this);
 
     }
 
@@ -228,7 +310,13 @@ namespace Lynx
     {
         //MeshComponentと同じ
         MeshComponent::create(meshes);
+        //登録済みなら古いスケルトンのまま評価されないように外す
+        if(auto animationSystem = AnimationSystem::getCurrent())
+            animationSystem->cancel(this);
         mSkeleton = skeleton;
+        mCurrent.reset();
+        mPrevious.reset();
+        mLayers.clear();
     }
 
     const std::vector<SkeletalMeshComponent::Bone>& SkeletalMeshComponent::getBones() const
@@ -252,7 +340,8 @@ namespace Lynx
     {
         assert(mSkeleton);
         mAnimationIndex = animationIndex;
-        mStart = std::chrono::high_resolution_clock::now();
+        mCurrent = startPlayback(animationIndex);
+        mPrevious.reset();
     }
 
     const std::optional<uint32_t>& SkeletalMeshComponent::getAnimationIndex() const
@@ -261,6 +350,83 @@ namespace Lynx
         return mAnimationIndex;
     }
 
+    void SkeletalMeshComponent::setAnimationTime(double second)
+    {
+        //setAnimationIndex()されていない
+        assert(mCurrent);
+        mCurrent->time = second;
+    }
+
+    double SkeletalMeshComponent::getAnimationTime() const
+    {
+        assert(mCurrent);
+        return mCurrent->time;
+    }
+
+    void SkeletalMeshComponent::crossFade(uint32_t animationIndex, float duration)
+    {
+        assert(mSkeleton);
+        if(!mCurrent || duration <= 0)
+        {
+            setAnimationIndex(animationIndex);
+            return;
+        }
+
+        mAnimationIndex = animationIndex;
+        mPrevious = std::move(mCurrent);
+        mCurrent = startPlayback(animationIndex);
+        mFadeTime = 0;
+        mFadeDuration = duration;
+    }
+
+    size_t SkeletalMeshComponent::addLayer(uint32_t animationIndex, float weight, bool additive, const std::vector<float>& mask)
+    {
+        assert(mSkeleton);
+        assert(mask.empty() || mask.size() == mSkeleton->getNodeNum());
+
+        auto& layer = mLayers.emplace_back();
+        layer.playback = startPlayback(animationIndex);
+        layer.weight = weight;
+        layer.additive = additive;
+        layer.mask = mask;
+
+        //加算はクリップの先頭の姿勢を基準にする
+        if(additive)
+        {
+            std::vector<uint32_t> cursors(mSkeleton->getCursorNum(), 0);
+            mSkeleton->samplePose(animationIndex, 0, cursors.data(), layer.reference);
+        }
+
+        return mLayers.size() - 1;
+    }
+
+    void SkeletalMeshComponent::setLayerWeight(size_t layer, float weight)
+    {
+        assert(layer < mLayers.size());
+        mLayers[layer].weight = weight;
+    }
+
+    void SkeletalMeshComponent::clearLayers()
+    {
+        mLayers.clear();
+    }
+
+    const SkeletalMeshComponent::Skeleton& SkeletalMeshComponent::getSkeleton() const
+    {
+        assert(mSkeleton);
+        return mSkeleton.value();
+    }
+
+    SkeletalMeshComponent::Playback SkeletalMeshComponent::startPlayback(uint32_t animationIndex) const
+    {
+        Playback playback;
+        playback.animation = animationIndex;
+        playback.time = 0;
+        playback.cursors.assign(mSkeleton->getCursorNum(), 0);
+
+        return playback;
+    }
+
     void SkeletalMeshComponent::setTimeScale(float timeScale)
     {
         assert(timeScale > 0);
@@ -276,13 +442,65 @@ namespace Lynx
     {
         MeshComponent::update();
         //アニメーション更新
-        auto&& now = std::chrono::high_resolution_clock::now();
-        double time = std::chrono::duration_cast<std::chrono::microseconds>(now - mStart).count() / 1000000.;
+        if(!mCurrent)
+            return;
 
-        if(mAnimationIndex)
+        //途中で倍率を変えても再生位置が飛ばないよう, 倍率は毎フレームのdeltaに掛ける
+        const double delta = FrameClock::getCurrent().getDeltaTime() * mTimeScale;
+        mCurrent->time += delta;
+        for(auto& layer : mLayers)
+            layer.playback.time += delta;
+
+        if(mPrevious)
         {
-            //std::cerr << "animation time : " << time << "\n";
-            mSkeleton->update(time * mTimeScale, mAnimationIndex.value());
+            mPrevious->time += delta;
+            mFadeTime += static_cast<float>(delta);
+            if(mFadeTime >= mFadeDuration)
+                mPrevious.reset();
         }
+
+        //AnimationSystemがあれば評価はまとめて後で
+        if(auto animationSystem = AnimationSystem::getCurrent())
+            animationSystem->submit(this);
+        else
+            evaluate(static_cast<float>(mCurrent->time));
+    }
+
+    void SkeletalMeshComponent::evaluate(float second)
+    {
+        //ローカルの姿勢で混ぜてから、最後に1回だけ行列にする
+        mSkeleton->samplePose(mCurrent->animation, second, mCurrent->cursors.data(), mPose);
+
+        if(mPrevious)
+        {
+            mSkeleton->samplePose(mPrevious->animation, static_cast<float>(mPrevious->time), mPrevious->cursors.data(), mBlendPose);
+            blendPose(mBlendPose, mPose, mFadeTime / mFadeDuration);
+            std::swap(mPose, mBlendPose);
+        }
+
+        for(auto& layer : mLayers)
+        {
+            if(layer.weight <= 0)
+                continue;
+
+            mSkeleton->samplePose(layer.playback.animation, static_cast<float>(layer.playback.time), layer.playback.cursors.data(), mBlendPose);
+            const float* mask = layer.mask.empty() ? nullptr : layer.mask.data();
+            if(layer.additive)
+                addPose(mPose, mBlendPose, layer.reference, layer.weight, mask);
+            else
+                blendPose(mPose, mBlendPose, layer.weight, mask);
+        }
+
+        mSkeleton->applyPose(mPose);
+    }
+
+    void SkeletalMeshComponent::copyBones(const SkeletalMeshComponent& source)
+    {
+        auto& bones = mSkeleton->bones;
+        const auto& sourceBones = source.mSkeleton->bones;
+        assert(bones.size() == sourceBones.size());
+        //offsetは同じモデルなので同じ
+        for(size_t i = 0; i < bones.size(); ++i)
+            bones[i].transform = sourceBones[i].transform;
     }
 }
\ No newline at end of file
@@ -21,6 +21,7 @@ namespace Lynx
     , mPCMDataSize(0)
     , mBufPos(0)
     , mVolumeRate(0.3f)
+    , mStartTime(0)
     {
         if(!instanceCount)
         {
@@ -94,7 +95,8 @@ namespace Lynx
 
         mPlayFlag = true;
         Pa_StartStream(mpStream.value());
-        mStartTime = std::chrono::high_resolution_clock::now();
+        mStartTime = Pa_GetStreamTime(mpStream.value());
+        mPlayingDuration = 0;
     }
 
     void SoundComponent::stop()
@@ -113,8 +115,8 @@ namespace Lynx
     {
         if(mPlayFlag)
         {
-            auto&& now = std::chrono::high_resolution_clock::now();
-            mPlayingDuration = std::chrono::duration_cast<std::chrono::microseconds>(now - mStartTime).count() / 1000000.;
+            //ストリームは実時間で鳴るので, フレームの時間(倍率や上限で丸められる)は足さずにストリームの時計から読む
+            mPlayingDuration = Pa_GetStreamTime(mpStream.value()) - mStartTime;
         }
     }
 
@@ -0,0 +1,201 @@
+#include <Lynx/System/AnimationSystem.hpp>
+
+#include <Lynx/System/JobSystem.hpp>
+#include <Lynx/Components/SkeletalMeshComponent.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace Lynx
+{
+    namespace
+    {
+        AnimationSystem* gCurrentAnimationSystem = nullptr;
+    }
+
+    AnimationSystem::AnimationSystem()
+    : mJobSystem(nullptr)
+    , mInstancing(true)
+    , mTimeQuantum(0)
+    , mGrain(16)
+    , mStatistics{0, 0, 0}
+    {
+
+    }
+
+    AnimationSystem::~AnimationSystem()
+    {
+        for(auto& component : mSubmitted)
+            component->mSubmitted = false;
+
+        if(gCurrentAnimationSystem == this)
+            gCurrentAnimationSystem = nullptr;
+    }
+
+    void AnimationSystem::setJobSystem(JobSystem* jobSystem)
+    {
+        mJobSystem = jobSystem;
+    }
+
+    void AnimationSystem::submit(SkeletalMeshComponent* component)
+    {
+        assert(component);
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(component->mSubmitted)
+            return;
+
+        component->mSubmitted = true;
+        mSubmitted.emplace_back(component);
+    }
+
+    void AnimationSystem::cancel(SkeletalMeshComponent* component)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(!component->mSubmitted)
+            return;
+
+        component->mSubmitted = false;
+        mSubmitted.erase(std::find(mSubmitted.begin(), mSubmitted.end(), component));
+    }
+
+    void AnimationSystem::evaluate()
+    {
+        //ここから先は登録されない前提(アクタの更新が終わってから呼ぶ)
+        mStatistics = Statistics{static_cast<uint32_t>(mSubmitted.size()), 0, 0};
+        mLeaders.clear();
+        mFollowers.clear();
+        mInstances.clear();
+
+        for(auto& component : mSubmitted)
+        {
+            component->mSubmitted = false;
+
+            //登録後にcreate()し直された
+            const auto& playback = component->mCurrent;
+            if(!playback)
+                continue;
+
+            //ブレンド中のものは共有できない
+            if(!mInstancing || component->mPrevious || !component->mLayers.empty())
+            {
+                mLeaders.emplace_back(component, static_cast<float>(playback->time));
+                continue;
+            }
+
+            //範囲外のクリップは共有せず、その場で評価するときと同じくバインドポーズにさせる
+            const auto& skeleton = component->mSkeleton;
+            if(playback->animation >= skeleton->getAnimationNum())
+            {
+                mLeaders.emplace_back(component, static_cast<float>(playback->time));
+                continue;
+            }
+
+            //再生位置はクリップの中に折り返してから比べる
+            const auto& clip = skeleton->getAnimation(playback->animation);
+            float time = clip.duration > 0 ? std::fmod(static_cast<float>(playback->time), clip.duration) : 0;
+            if(mTimeQuantum > 0)
+                time = std::floor(time / mTimeQuantum) * mTimeQuantum;
+
+            //同じ計算で同じ値になったものだけ共有するので、ビット列のまま比べる(0以上なら大小も同じ)
+            uint32_t timeBits;
+            std::memcpy(&timeBits, &time, sizeof(timeBits));
+            mInstances.emplace_back(Instance{&clip, time, timeBits, component});
+        }
+        mSubmitted.clear();
+
+        //同じクリップと再生位置が並ぶようにして、先頭だけ評価する
+        std::sort(mInstances.begin(), mInstances.end(), [](const Instance& a, const Instance& b)
+        {
+            return a.clip != b.clip ? std::less<const AnimationClip*>()(a.clip, b.clip) : a.timeBits < b.timeBits;
+        });
+
+        for(size_t i = 0; i < mInstances.size();)
+        {
+            const auto& leader = mInstances[i];
+            mLeaders.emplace_back(leader.component, leader.time);
+
+            size_t j = i + 1;
+            for(; j < mInstances.size() && mInstances[j].clip == leader.clip && mInstances[j].timeBits == leader.timeBits; ++j)
+            {
+                auto& follower = *mInstances[j].component;
+                //軸を差し替えているとボーン行列が変わる
+                if(follower.mSkeleton->defaultAxis == leader.component->mSkeleton->defaultAxis)
+                    mFollowers.emplace_back(&follower, leader.component);
+                else
+                    mLeaders.emplace_back(&follower, leader.time);
+            }
+            i = j;
+        }
+
+        mStatistics.evaluatedCount = static_cast<uint32_t>(mLeaders.size());
+        mStatistics.sharedCount = static_cast<uint32_t>(mFollowers.size());
+
+        const auto evaluateLeaders = [this](size_t begin, size_t end)
+        {
+            for(size_t i = begin; i < end; ++i)
+                mLeaders[i].first->evaluate(mLeaders[i].second);
+        };
+
+        const auto copyFollowers = [this](size_t begin, size_t end)
+        {
+            for(size_t i = begin; i < end; ++i)
+                mFollowers[i].first->copyBones(*mFollowers[i].second);
+        };
+
+        //コピーは評価が全部終わってから
+        if(mJobSystem)
+        {
+            mJobSystem->parallelFor(0, mLeaders.size(), mGrain, evaluateLeaders);
+            mJobSystem->parallelFor(0, mFollowers.size(), mGrain * 4, copyFollowers);
+        }
+        else
+        {
+            evaluateLeaders(0, mLeaders.size());
+            copyFollowers(0, mFollowers.size());
+        }
+    }
+
+    void AnimationSystem::setInstancing(bool instancing)
+    {
+        mInstancing = instancing;
+    }
+
+    bool AnimationSystem::getInstancing() const
+    {
+        return mInstancing;
+    }
+
+    void AnimationSystem::setTimeQuantum(float timeQuantum)
+    {
+        assert(timeQuantum >= 0);
+        mTimeQuantum = timeQuantum;
+    }
+
+    float AnimationSystem::getTimeQuantum() const
+    {
+        return mTimeQuantum;
+    }
+
+    void AnimationSystem::setGrain(uint32_t grain)
+    {
+        assert(grain > 0);
+        mGrain = grain;
+    }
+
+    const AnimationSystem::Statistics& AnimationSystem::getStatistics() const
+    {
+        return mStatistics;
+    }
+
+    void AnimationSystem::setCurrent(AnimationSystem* animationSystem)
+    {
+        gCurrentAnimationSystem = animationSystem;
+    }
+
+    AnimationSystem* AnimationSystem::getCurrent()
+    {
+        return gCurrentAnimationSystem;
+    }
+}
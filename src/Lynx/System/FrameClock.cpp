@@ -0,0 +1,143 @@
+#include <Lynx/System/FrameClock.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace Lynx
+{
+    namespace
+    {
+        FrameClock* gCurrentClock = nullptr;
+    }
+
+    FrameClock::FrameClock()
+    : mPrev(std::chrono::steady_clock::now())
+    , mDeltaTime(0)
+    , mUnscaledDeltaTime(0)
+    , mTime(0)
+    , mFrameCount(0)
+    , mTimeScale(1.f)
+    , mPaused(false)
+    , mFixedDeltaTime(0)
+    , mMaxDeltaTime(0.25f)
+    , mInterpolationAlpha(1.f)
+    {
+
+    }
+
+    FrameClock::~FrameClock()
+    {
+        if(gCurrentClock == this)
+            gCurrentClock = nullptr;
+    }
+
+    void FrameClock::tick()
+    {
+        const double elapsed = measure();
+        advance(mFixedDeltaTime > 0 ? mFixedDeltaTime : elapsed);
+        mInterpolationAlpha = 1.f;
+    }
+
+    double FrameClock::measure()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - mPrev).count();
+        mPrev = now;
+
+        return elapsed;
+    }
+
+    void FrameClock::advance(double realDeltaTime)
+    {
+        assert(realDeltaTime >= 0);
+        mUnscaledDeltaTime = static_cast<float>(std::min<double>(realDeltaTime, mMaxDeltaTime));
+        mDeltaTime = mPaused ? 0 : mUnscaledDeltaTime * mTimeScale;
+        mTime += mDeltaTime;
+        ++mFrameCount;
+    }
+
+    float FrameClock::getDeltaTime() const
+    {
+        return mDeltaTime;
+    }
+
+    float FrameClock::getUnscaledDeltaTime() const
+    {
+        return mUnscaledDeltaTime;
+    }
+
+    double FrameClock::getTime() const
+    {
+        return mTime;
+    }
+
+    uint64_t FrameClock::getFrameCount() const
+    {
+        return mFrameCount;
+    }
+
+    void FrameClock::setTimeScale(float timeScale)
+    {
+        assert(timeScale >= 0);
+        mTimeScale = timeScale;
+    }
+
+    float FrameClock::getTimeScale() const
+    {
+        return mTimeScale;
+    }
+
+    void FrameClock::setPaused(bool paused)
+    {
+        mPaused = paused;
+    }
+
+    bool FrameClock::isPaused() const
+    {
+        return mPaused;
+    }
+
+    void FrameClock::setFixedDeltaTime(float fixedDeltaTime)
+    {
+        assert(fixedDeltaTime >= 0);
+        mFixedDeltaTime = fixedDeltaTime;
+    }
+
+    float FrameClock::getFixedDeltaTime() const
+    {
+        return mFixedDeltaTime;
+    }
+
+    void FrameClock::setInterpolationAlpha(float alpha)
+    {
+        assert(0 <= alpha && alpha <= 1.f);
+        mInterpolationAlpha = alpha;
+    }
+
+    float FrameClock::getInterpolationAlpha() const
+    {
+        return mInterpolationAlpha;
+    }
+
+    void FrameClock::setMaxDeltaTime(float maxDeltaTime)
+    {
+        assert(maxDeltaTime > 0);
+        mMaxDeltaTime = maxDeltaTime;
+    }
+
+    float FrameClock::getMaxDeltaTime() const
+    {
+        return mMaxDeltaTime;
+    }
+
+    void FrameClock::setCurrent(FrameClock* clock)
+    {
+        gCurrentClock = clock;
+    }
+
+    const FrameClock& FrameClock::getCurrent()
+    {
+        static const FrameClock stopped;
+        return gCurrentClock ? *gCurrentClock : stopped;
+    }
+}
@@ -0,0 +1,104 @@
+#include <Lynx/System/FrustumCuller.hpp>
+#include <Lynx/System/JobSystem.hpp>
+
+#include <atomic>
+
+namespace Lynx
+{
+    Frustum Frustum::fromMatrix(const glm::mat4& m)
+    {
+        //Gribb-Hartmann, glmは列優先なのでm[列][行]
+        //nearはz >= -wで取るので、深度が0..1の射影でも内側を削ることはない(少し甘くなるだけ)
+        Frustum frustum;
+        for(int i = 0; i < 3; ++i)
+        {
+            const glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+            const glm::vec4 w(m[0][3], m[1][3], m[2][3], m[3][3]);
+            frustum.planes[i * 2 + 0] = w + row;
+            frustum.planes[i * 2 + 1] = w - row;
+        }
+
+        for(auto& plane : frustum.planes)
+            plane /= glm::length(glm::vec3(plane));
+
+        return frustum;
+    }
+
+    FrustumCuller::FrustumCuller()
+    {
+
+    }
+
+    void FrustumCuller::clear()
+    {
+        mX.clear();
+        mY.clear();
+        mZ.clear();
+        mRadius.clear();
+    }
+
+    void FrustumCuller::reserve(size_t size)
+    {
+        mX.reserve(size);
+        mY.reserve(size);
+        mZ.reserve(size);
+        mRadius.reserve(size);
+    }
+
+    uint32_t FrustumCuller::add(const glm::vec3& center, float radius)
+    {
+        mX.emplace_back(center.x);
+        mY.emplace_back(center.y);
+        mZ.emplace_back(center.z);
+        mRadius.emplace_back(radius);
+
+        return static_cast<uint32_t>(mX.size() - 1);
+    }
+
+    size_t FrustumCuller::size() const
+    {
+        return mX.size();
+    }
+
+    uint32_t FrustumCuller::cull(const Frustum& frustum, std::vector<uint8_t>& visible_out, JobSystem* jobSystem) const
+    {
+        const size_t size = mX.size();
+        visible_out.assign(size, 1);
+
+        if(!jobSystem)
+            return cullRange(frustum, 0, size, visible_out.data());
+
+        std::atomic<uint32_t> count(0);
+        jobSystem->parallelFor(0, size, 4096, [&](size_t begin, size_t end)
+        {
+            count.fetch_add(cullRange(frustum, begin, end, visible_out.data()), std::memory_order_relaxed);
+        });
+
+        return count.load();
+    }
+
+    uint32_t FrustumCuller::cullRange(const Frustum& frustum, size_t begin, size_t end, uint8_t* visible) const
+    {
+        const float* x = mX.data();
+        const float* y = mY.data();
+        const float* z = mZ.data();
+        const float* r = mRadius.data();
+
+        //平面ごとに全要素を流す(分岐なしでベクトル化しやすい形)
+        for(const auto& plane : frustum.planes)
+        {
+            const float a = plane.x, b = plane.y, c = plane.z, d = plane.w;
+            for(size_t i = begin; i < end; ++i)
+            {
+                const float dist = a * x[i] + b * y[i] + c * z[i] + d;
+                visible[i] &= static_cast<uint8_t>(dist >= -r[i]);
+            }
+        }
+
+        uint32_t count = 0;
+        for(size_t i = begin; i < end; ++i)
+            count += visible[i];
+
+        return count;
+    }
+}
@@ -0,0 +1,333 @@
+#include <Lynx/System/GeometryArena.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Lynx
+{
+    void GeometryArena::FreeList::reset(uint32_t capacity)
+    {
+        mBlocks.clear();
+        if(capacity > 0)
+            mBlocks.push_back({0, capacity});
+    }
+
+    bool GeometryArena::FreeList::allocate(uint32_t size, uint32_t& offset_out)
+    {
+        for(auto itr = mBlocks.begin(); itr != mBlocks.end(); ++itr)
+        {
+            if(itr->size < size)
+                continue;
+
+            offset_out = itr->offset;
+            itr->offset += size;
+            itr->size -= size;
+            if(itr->size == 0)
+                mBlocks.erase(itr);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void GeometryArena::FreeList::free(uint32_t offset, uint32_t size)
+    {
+        if(size == 0)
+            return;
+
+        auto itr = std::lower_bound(mBlocks.begin(), mBlocks.end(), offset, [](const Block& block, uint32_t value){ return block.offset < value; });
+        itr = mBlocks.insert(itr, {offset, size});
+
+        //後ろと結合
+        if(itr + 1 != mBlocks.end() && itr->offset + itr->size == (itr + 1)->offset)
+        {
+            itr->size += (itr + 1)->size;
+            mBlocks.erase(itr + 1);
+        }
+
+        //前と結合
+        if(itr != mBlocks.begin() && (itr - 1)->offset + (itr - 1)->size == itr->offset)
+        {
+            (itr - 1)->size += itr->size;
+            mBlocks.erase(itr);
+        }
+    }
+
+    uint32_t GeometryArena::FreeList::getFreeSize() const
+    {
+        uint32_t size = 0;
+        for(const auto& block : mBlocks)
+            size += block.size;
+
+        return size;
+    }
+
+    GeometryArena::GeometryArena(const std::shared_ptr<IRenderContext>& context, uint32_t pageVertexCount, uint32_t pageIndexCount)
+    : mContext(context)
+    , mPageVertexCount(pageVertexCount)
+    , mPageIndexCount(pageIndexCount)
+    , mStatistics()
+    {
+
+    }
+
+    GeometryArena::~GeometryArena()
+    {
+        for(auto& page : mPages)
+        {
+            mContext->destroyBuffer(page.VB);
+            mContext->destroyBuffer(page.IB);
+        }
+    }
+
+    uint32_t GeometryArena::createPage(uint32_t vertexCapacity, uint32_t indexCapacity)
+    {
+        auto& page = mPages.emplace_back();
+        page.vertexCapacity = vertexCapacity;
+        page.indexCapacity = indexCapacity;
+        page.vertexFreeList.reset(vertexCapacity);
+        page.indexFreeList.reset(indexCapacity);
+        page.vertices.resize(vertexCapacity);
+        page.indices.resize(indexCapacity);
+        page.vertexDirtyEnd = 0;
+        page.indexDirtyEnd = 0;
+        page.freed = false;
+
+        Cutlass::BufferInfo bi;
+        bi.setVertexBuffer<MeshComponent::Vertex>(vertexCapacity);
+        if(Cutlass::Result::eSuccess != mContext->createBuffer(bi, page.VB))
+            assert(!"failed to create vertex buffer!");
+
+        bi.setIndexBuffer<uint32_t>(indexCapacity);
+        if(Cutlass::Result::eSuccess != mContext->createBuffer(bi, page.IB))
+            assert(!"failed to create index buffer!");
+
+        ++mStatistics.pageCount;
+        mStatistics.vertexCapacity += vertexCapacity;
+        mStatistics.indexCapacity += indexCapacity;
+
+        return static_cast<uint32_t>(mPages.size() - 1);
+    }
+
+    GeometryArena::Handle GeometryArena::allocate(const MeshComponent::Mesh& mesh)
+    {
+        const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        const uint32_t indexCount = static_cast<uint32_t>(mesh.indices.size());
+
+        Range range;
+        range.vertexCount = vertexCount;
+        range.indexCount = indexCount;
+
+        bool found = false;
+        for(uint32_t i = 0; i < mPages.size() && !found; ++i)
+        {
+            auto& page = mPages[i];
+            if(page.vertexFreeList.getFreeSize() < vertexCount || page.indexFreeList.getFreeSize() < indexCount)
+                continue;
+
+            if(!page.vertexFreeList.allocate(vertexCount, range.vertexOffset))
+                continue;
+
+            if(!page.indexFreeList.allocate(indexCount, range.firstIndex))
+            {
+                page.vertexFreeList.free(range.vertexOffset, vertexCount);
+                continue;
+            }
+
+            range.page = i;
+            found = true;
+        }
+
+        if(!found)
+        {//ページサイズより大きいメッシュは専用のページにする
+            range.page = createPage(std::max(vertexCount, mPageVertexCount), std::max(indexCount, mPageIndexCount));
+            auto& page = mPages[range.page];
+            page.vertexFreeList.allocate(vertexCount, range.vertexOffset);
+            page.indexFreeList.allocate(indexCount, range.firstIndex);
+        }
+
+        {
+            auto& page = mPages[range.page];
+            std::copy(mesh.vertices.begin(), mesh.vertices.end(), page.vertices.begin() + range.vertexOffset);
+            std::copy(mesh.indices.begin(), mesh.indices.end(), page.indices.begin() + range.firstIndex);
+            page.vertexDirtyEnd = std::max(page.vertexDirtyEnd, range.vertexOffset + vertexCount);
+            page.indexDirtyEnd = std::max(page.indexDirtyEnd, range.firstIndex + indexCount);
+        }
+
+        Handle handle;
+        if(mFreeHandles.empty())
+        {
+            handle = static_cast<Handle>(mAllocations.size());
+            mAllocations.emplace_back();
+        }
+        else
+        {
+            handle = mFreeHandles.back();
+            mFreeHandles.pop_back();
+        }
+
+        mAllocations[handle].range = range;
+        mAllocations[handle].alive = true;
+
+        ++mStatistics.allocationCount;
+        mStatistics.usedVertices += vertexCount;
+        mStatistics.usedIndices += indexCount;
+
+        return handle;
+    }
+
+    void GeometryArena::free(Handle handle)
+    {
+        assert(handle < mAllocations.size() && mAllocations[handle].alive);
+        auto& allocation = mAllocations[handle];
+        const auto& range = allocation.range;
+
+        auto& page = mPages[range.page];
+        page.vertexFreeList.free(range.vertexOffset, range.vertexCount);
+        page.indexFreeList.free(range.firstIndex, range.indexCount);
+        //中身は残しておいてよい(どこからも参照されない)
+        page.freed = true;
+
+        --mStatistics.allocationCount;
+        mStatistics.usedVertices -= range.vertexCount;
+        mStatistics.usedIndices -= range.indexCount;
+
+        allocation.alive = false;
+        mFreeHandles.emplace_back(handle);
+    }
+
+    const GeometryArena::Range& GeometryArena::get(Handle handle) const
+    {
+        assert(handle < mAllocations.size() && mAllocations[handle].alive);
+        return mAllocations[handle].range;
+    }
+
+    bool GeometryArena::equals(Handle handle, const MeshComponent::Mesh& mesh) const
+    {
+        const auto& range = get(handle);
+        if(range.vertexCount != mesh.vertices.size() || range.indexCount != mesh.indices.size())
+            return false;
+
+        const auto& page = mPages[range.page];
+        return std::memcmp(&page.vertices[range.vertexOffset], mesh.vertices.data(), range.vertexCount * sizeof(MeshComponent::Vertex)) == 0
+            && std::memcmp(&page.indices[range.firstIndex], mesh.indices.data(), range.indexCount * sizeof(uint32_t)) == 0;
+    }
+
+    const Cutlass::HBuffer& GeometryArena::getVB(uint32_t page) const
+    {
+        assert(page < mPages.size());
+        return mPages[page].VB;
+    }
+
+    const Cutlass::HBuffer& GeometryArena::getIB(uint32_t page) const
+    {
+        assert(page < mPages.size());
+        return mPages[page].IB;
+    }
+
+    void GeometryArena::flush()
+    {
+        for(auto& page : mPages)
+        {
+            //変更のない側のバッファは転送しない
+            if(page.vertexDirtyEnd > 0)
+            {
+                const size_t vbSize = page.vertexDirtyEnd * sizeof(MeshComponent::Vertex);
+                mContext->writeBuffer(vbSize, page.vertices.data(), page.VB);
+                mStatistics.flushedBytes += vbSize;
+                page.vertexDirtyEnd = 0;
+            }
+
+            if(page.indexDirtyEnd > 0)
+            {
+                const size_t ibSize = page.indexDirtyEnd * sizeof(uint32_t);
+                mContext->writeBuffer(ibSize, page.indices.data(), page.IB);
+                mStatistics.flushedBytes += ibSize;
+                page.indexDirtyEnd = 0;
+            }
+        }
+    }
+
+    bool GeometryArena::compact(float threshold)
+    {
+        bool moved = false;
+
+        std::vector<Handle> live;
+        for(uint32_t i = 0; i < mPages.size(); ++i)
+        {
+            auto& page = mPages[i];
+            if(!page.freed)
+                continue;
+            page.freed = false;
+
+            const uint32_t vertexFree = page.vertexFreeList.getFreeSize();
+            const uint32_t indexFree = page.indexFreeList.getFreeSize();
+            const uint32_t vertexUsed = page.vertexCapacity - vertexFree;
+            const uint32_t indexUsed = page.indexCapacity - indexFree;
+
+            live.clear();
+            for(Handle h = 0; h < mAllocations.size(); ++h)
+                if(mAllocations[h].alive && mAllocations[h].range.page == i)
+                    live.emplace_back(h);
+
+            uint32_t vertexEnd = 0;
+            uint32_t indexEnd = 0;
+            for(const auto& h : live)
+            {
+                const auto& range = mAllocations[h].range;
+                vertexEnd = std::max(vertexEnd, range.vertexOffset + range.vertexCount);
+                indexEnd = std::max(indexEnd, range.firstIndex + range.indexCount);
+            }
+
+            //末尾以外の空き(穴)が少なければ何もしない
+            const uint32_t vertexHoles = vertexEnd - vertexUsed;
+            const uint32_t indexHoles = indexEnd - indexUsed;
+            if(static_cast<float>(vertexHoles) <= static_cast<float>(page.vertexCapacity) * threshold && static_cast<float>(indexHoles) <= static_cast<float>(page.indexCapacity) * threshold)
+                continue;
+
+            //前から詰める(移動先は常に移動元以下なので上書きしても壊れない)
+            std::sort(live.begin(), live.end(), [this](Handle a, Handle b){ return mAllocations[a].range.vertexOffset < mAllocations[b].range.vertexOffset; });
+            uint32_t offset = 0;
+            for(const auto& h : live)
+            {
+                auto& range = mAllocations[h].range;
+                if(range.vertexOffset != offset)
+                    std::memmove(&page.vertices[offset], &page.vertices[range.vertexOffset], range.vertexCount * sizeof(MeshComponent::Vertex));
+                range.vertexOffset = offset;
+                offset += range.vertexCount;
+            }
+
+            //インデックスはvertexOffset相対なので値はそのまま
+            std::sort(live.begin(), live.end(), [this](Handle a, Handle b){ return mAllocations[a].range.firstIndex < mAllocations[b].range.firstIndex; });
+            offset = 0;
+            for(const auto& h : live)
+            {
+                auto& range = mAllocations[h].range;
+                if(range.firstIndex != offset)
+                    std::memmove(&page.indices[offset], &page.indices[range.firstIndex], range.indexCount * sizeof(uint32_t));
+                range.firstIndex = offset;
+                offset += range.indexCount;
+            }
+
+            uint32_t head = 0;
+            page.vertexFreeList.reset(page.vertexCapacity);
+            page.vertexFreeList.allocate(vertexUsed, head);
+            page.indexFreeList.reset(page.indexCapacity);
+            page.indexFreeList.allocate(indexUsed, head);
+            //動いたものは全部[0, used)に入っている
+            page.vertexDirtyEnd = std::max(page.vertexDirtyEnd, vertexUsed);
+            page.indexDirtyEnd = std::max(page.indexDirtyEnd, indexUsed);
+
+            ++mStatistics.compactionCount;
+            moved = true;
+        }
+
+        return moved;
+    }
+
+    const GeometryArena::Statistics& GeometryArena::getStatistics() const
+    {
+        return mStatistics;
+    }
+}
@@ -2,18 +2,25 @@
 
 namespace Lynx
 {
+    //ヘッドレス(コンテキストなし)では何も押されていない扱い
     uint32_t Input::getKey(Cutlass::Key key)
     {
+        if(!mContext)
+            return 0;
+
         return mContext->getKey(key);
     }
 
     bool Input::getKeyDown(Cutlass::Key key)
     {
-        return mContext->getKey(key) == 1;
+        return getKey(key) == 1;
     }
 
     glm::vec2 Input::getMousePos()
     {
+        if(!mContext)
+            return glm::vec2(0);
+
         double x, y;
         mContext->getMousePos(x, y);
         return glm::vec2(x, y);
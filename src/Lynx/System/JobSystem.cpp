@@ -0,0 +1,232 @@
+#include <Lynx/System/JobSystem.hpp>
+
+#include <cassert>
+#include <chrono>
+
+namespace Lynx
+{
+    namespace
+    {
+        //今のスレッドがどのJobSystemのどのキューの持ち主か
+        thread_local const JobSystem* tCurrentSystem = nullptr;
+        thread_local uint32_t tQueueIndex = 0;
+    }
+
+    JobSystem::Counter::Counter()
+    : mPending(0)
+    {
+
+    }
+
+    bool JobSystem::Counter::done() const
+    {
+        if(mPending.load(std::memory_order_acquire) != 0)
+            return false;
+
+        //最後のfinish()がロックを手放すまで待つ(手放した後はもうこのカウンタに触らないので破棄してよい)
+        std::lock_guard<std::mutex> lock(mMutex);
+        return true;
+    }
+
+    JobSystem::JobSystem(uint32_t threadCount)
+    : mRunning(true)
+    , mQueuedCount(0)
+    , mExecutedCount(0)
+    , mStolenCount(0)
+    {
+        if(threadCount == 0)
+        {
+            const uint32_t hardware = std::thread::hardware_concurrency();
+            threadCount = hardware > 1 ? hardware - 1 : 0;
+        }
+
+        mQueues.reserve(threadCount + 1);
+        for(uint32_t i = 0; i < threadCount + 1; ++i)
+            mQueues.emplace_back(std::make_unique<Queue>());
+
+        mWorkers.reserve(threadCount);
+        for(uint32_t i = 0; i < threadCount; ++i)
+            mWorkers.emplace_back(&JobSystem::workerMain, this, i + 1);
+    }
+
+    JobSystem::~JobSystem()
+    {
+        while(tryRunOne())
+            ;
+
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            mRunning.store(false);
+        }
+        mWake.notify_all();
+
+        for(auto& worker : mWorkers)
+            worker.join();
+    }
+
+    void JobSystem::run(Job job, Counter* counter)
+    {
+        if(counter)
+            counter->mPending.fetch_add(1, std::memory_order_relaxed);
+
+        push(std::move(job), counter);
+    }
+
+    void JobSystem::runAfter(Counter& dependency, Job job, Counter* counter)
+    {
+        if(counter)
+            counter->mPending.fetch_add(1, std::memory_order_relaxed);
+
+        {
+            //finish()はロックを取った中で0にするので、ここで0でなければ必ず後で拾われる
+            std::lock_guard<std::mutex> lock(dependency.mMutex);
+            if(dependency.mPending.load(std::memory_order_acquire) != 0)
+            {
+                dependency.mContinuations.push_back({std::move(job), counter});
+                return;
+            }
+        }
+
+        push(std::move(job), counter);
+    }
+
+    void JobSystem::wait(Counter& counter)
+    {
+        while(!counter.done())
+        {
+            if(!tryRunOne())
+                std::this_thread::yield();
+        }
+    }
+
+    uint32_t JobSystem::getWorkerCount() const
+    {
+        return static_cast<uint32_t>(mWorkers.size());
+    }
+
+    JobSystem::Statistics JobSystem::getStatistics() const
+    {
+        Statistics statistics;
+        statistics.executedCount = mExecutedCount.load(std::memory_order_relaxed);
+        statistics.stolenCount = mStolenCount.load(std::memory_order_relaxed);
+
+        return statistics;
+    }
+
+    void JobSystem::push(Job&& job, Counter* counter)
+    {
+        //ワーカーなら自分のキュー, それ以外は共有キュー
+        const uint32_t index = tCurrentSystem == this ? tQueueIndex : 0;
+        {
+            auto& queue = *mQueues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.emplace_back(std::move(job), counter);
+        }
+
+        mQueuedCount.fetch_add(1, std::memory_order_release);
+        mWake.notify_one();
+    }
+
+    bool JobSystem::tryRunOne()
+    {
+        const uint32_t self = tCurrentSystem == this ? tQueueIndex : 0;
+        const uint32_t queueCount = static_cast<uint32_t>(mQueues.size());
+
+        std::pair<Job, Counter*> job;
+        bool found = false;
+
+        {//自分のキューは後ろから(直前に積んだものはキャッシュに乗っている)
+            auto& queue = *mQueues[self];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(!queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+                found = true;
+            }
+        }
+
+        //他のキューからは前から盗む
+        for(uint32_t i = 1; i < queueCount && !found; ++i)
+        {
+            const uint32_t victim = (self + i) % queueCount;
+            auto& queue = *mQueues[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(queue.jobs.empty())
+                continue;
+
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            found = true;
+            if(victim != 0)
+                mStolenCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if(!found)
+            return false;
+
+        mQueuedCount.fetch_sub(1, std::memory_order_acq_rel);
+        execute(job);
+
+        return true;
+    }
+
+    void JobSystem::execute(std::pair<Job, Counter*>& job)
+    {
+        job.first();
+        mExecutedCount.fetch_add(1, std::memory_order_relaxed);
+        finish(job.second);
+    }
+
+    void JobSystem::finish(Counter* counter)
+    {
+        if(!counter)
+            return;
+
+        //最後の1つでなければロックなしで減らす
+        uint32_t pending = counter->mPending.load(std::memory_order_relaxed);
+        while(pending > 1)
+        {
+            if(counter->mPending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel))
+                return;
+        }
+
+        //0にするのはロックの中で(done()とrunAfter()がこのロックで待ち合わせる)
+        std::vector<Counter::Continuation> continuations;
+        {
+            std::lock_guard<std::mutex> lock(counter->mMutex);
+            assert(counter->mPending.load() > 0);
+            if(counter->mPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                continuations.swap(counter->mContinuations);
+        }
+
+        //待っていたジョブを積む
+
+        for(auto& continuation : continuations)
+            push(std::move(continuation.job), continuation.counter);
+    }
+
+    void JobSystem::workerMain(uint32_t index)
+    {
+        tCurrentSystem = this;
+        tQueueIndex = index;
+
+        while(true)
+        {
+            if(tryRunOne())
+                continue;
+
+            //積まれたジョブを全部終わらせてから抜ける
+            if(!mRunning.load() && mQueuedCount.load() == 0)
+                break;
+
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mWake.wait_for(lock, std::chrono::milliseconds(1), [this]()
+            {
+                return mQueuedCount.load() > 0 || !mRunning.load();
+            });
+        }
+
+        tCurrentSystem = nullptr;
+    }
+}
@@ -74,9 +74,16 @@ namespace Lynx
         mTexturesLoaded.clear();
         mSkeleton.bones.clear();
         mSkeleton.boneMap.clear();
+        //メッシュもアニメーションも変換済みなのでaiSceneは捨てる
+        mScenes.clear();
         mLoaded = false;
     }
 
+    void Loader::setAnimationCompression(const AnimationCompression& compression)
+    {
+        mAnimationCompression = compression;
+    }
+
     //Static
     void Loader::load
     (
@@ -98,7 +105,9 @@ namespace Lynx
 
         auto&& scene = mScenes.emplace_back();
 
-        scene = std::shared_ptr<const aiScene>(mImporter.ReadFile(modelPath, aiProcess_Triangulate | aiProcess_FlipUVs));
+        //Importerが持ったままだと次のReadFileやImporterの破棄で消されるので、所有権をもらう
+        mImporter.ReadFile(modelPath, aiProcess_Triangulate | aiProcess_FlipUVs);
+        scene = std::shared_ptr<const aiScene>(mImporter.GetOrphanedScene());
 
         if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) 
         {
@@ -142,7 +151,9 @@ namespace Lynx
 
         auto&& scene = mScenes.emplace_back();
 
-        scene = std::shared_ptr<const aiScene>(mImporter.ReadFile(modelPath, aiProcess_Triangulate | aiProcess_FlipUVs));
+        //Importerが持ったままだと次のReadFileやImporterの破棄で消されるので、所有権をもらう
+        mImporter.ReadFile(modelPath, aiProcess_Triangulate | aiProcess_FlipUVs);
+        scene = std::shared_ptr<const aiScene>(mImporter.GetOrphanedScene());
 
         if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) 
         {
@@ -154,9 +165,9 @@ namespace Lynx
         mDirectory = mPath.substr(0, mPath.find_last_of("/\\"));
 
         mSkeleton.setGlobalInverse(glm::inverse(convert4x4(scene->mRootNode->mTransformation)));
-	    mSkeleton.setAIScene(scene);
 
         processNode(scene->mRootNode);
+        mSkeleton.build(*scene, mAnimationCompression);
 
         std::cerr << "bone num : " << mBoneNum << "\n";
     
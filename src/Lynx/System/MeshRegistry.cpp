@@ -0,0 +1,153 @@
+#include <Lynx/System/MeshRegistry.hpp>
+
+#include <algorithm>
+
+namespace Lynx
+{
+    namespace
+    {
+        //FNV-1a
+        uint64_t hashBytes(const void* data, size_t size, uint64_t seed)
+        {
+            const auto* p = static_cast<const unsigned char*>(data);
+            uint64_t hash = seed;
+            for(size_t i = 0; i < size; ++i)
+            {
+                hash ^= p[i];
+                hash *= 1099511628211ull;
+            }
+
+            return hash;
+        }
+    }
+
+    bool MeshRegistry::Key::operator==(const Key& another) const
+    {
+        return hash == another.hash && vertexCount == another.vertexCount && indexCount == another.indexCount;
+    }
+
+    size_t MeshRegistry::KeyHash::operator()(const Key& key) const
+    {
+        return static_cast<size_t>(key.hash);
+    }
+
+    MeshRegistry::Key MeshRegistry::makeKey(const MeshComponent::Mesh& mesh)
+    {
+        Key key;
+        key.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        key.indexCount = static_cast<uint32_t>(mesh.indices.size());
+        key.hash = hashBytes(mesh.vertices.data(), mesh.vertices.size() * sizeof(MeshComponent::Vertex), 14695981039346656037ull);
+        key.hash = hashBytes(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t), key.hash);
+
+        return key;
+    }
+
+    MeshRegistry::MeshRegistry(const std::shared_ptr<IRenderContext>& context)
+    : mArena(context)
+    , mSharedCount(0)
+    {
+
+    }
+
+    MeshRegistry::~MeshRegistry()
+    {
+        //ページはmArenaが破棄する
+    }
+
+    MeshRegistry::Handle MeshRegistry::acquire(const MeshComponent::Mesh& mesh)
+    {
+        const Key key = makeKey(mesh);
+
+        {//既にある
+            const auto& range = mHandles.equal_range(key);
+            for(auto itr = range.first; itr != range.second; ++itr)
+            {
+                auto& entry = mEntries[itr->second];
+                if(!mArena.equals(entry.allocation, mesh))
+                    continue;
+
+                ++entry.refCount;
+                ++mSharedCount;
+                return itr->second;
+            }
+        }
+
+        Handle handle;
+        if(mFreeHandles.empty())
+        {
+            handle = static_cast<Handle>(mEntries.size());
+            mEntries.emplace_back();
+        }
+        else
+        {
+            handle = mFreeHandles.back();
+            mFreeHandles.pop_back();
+        }
+
+        auto& entry = mEntries[handle];
+        entry.key = key;
+        entry.refCount = 1;
+        entry.allocation = mArena.allocate(mesh);
+
+        mHandles.emplace(key, handle);
+
+        return handle;
+    }
+
+    void MeshRegistry::release(Handle handle)
+    {
+        assert(handle < mEntries.size());
+        auto& entry = mEntries[handle];
+        assert(entry.refCount > 0);
+
+        if(--entry.refCount > 0)
+            return;
+
+        mArena.free(entry.allocation);
+        const auto& range = mHandles.equal_range(entry.key);
+        mHandles.erase(std::find_if(range.first, range.second, [handle](const auto& pair){ return pair.second == handle; }));
+        mFreeHandles.emplace_back(handle);
+    }
+
+    MeshRegistry::Geometry MeshRegistry::get(Handle handle) const
+    {
+        assert(handle < mEntries.size() && mEntries[handle].refCount > 0);
+        const auto& range = mArena.get(mEntries[handle].allocation);
+
+        Geometry geometry;
+        geometry.VB = mArena.getVB(range.page);
+        geometry.IB = mArena.getIB(range.page);
+        geometry.page = range.page;
+        geometry.vertexOffset = range.vertexOffset;
+        geometry.vertexCount = range.vertexCount;
+        geometry.firstIndex = range.firstIndex;
+        geometry.indexCount = range.indexCount;
+
+        return geometry;
+    }
+
+    void MeshRegistry::flush()
+    {
+        mArena.flush();
+    }
+
+    bool MeshRegistry::compact()
+    {
+        return mArena.compact();
+    }
+
+    const GeometryArena& MeshRegistry::getArena() const
+    {
+        return mArena;
+    }
+
+    size_t MeshRegistry::size() const
+    {
+        return mHandles.size();
+    }
+
+    uint64_t MeshRegistry::getSharedCount() const
+    {
+        return mSharedCount;
+    }
+}
@@ -0,0 +1,129 @@
+#include <Lynx/System/NullRenderContext.hpp>
+
+namespace Lynx
+{
+    NullRenderContext::NullRenderContext(uint32_t width, uint32_t height)
+    : mWidth(width)
+    , mHeight(height)
+    , mHandleCount(0)
+    {
+
+    }
+
+    NullRenderContext::~NullRenderContext()
+    {
+
+    }
+
+    const NullRenderContext::Statistics& NullRenderContext::getStatistics() const
+    {
+        return mStatistics;
+    }
+
+    void NullRenderContext::resetStatistics()
+    {
+        mStatistics = Statistics();
+    }
+
+    Cutlass::Result NullRenderContext::getWindowSize(const Cutlass::HWindow&, uint32_t& width, uint32_t& height)
+    {
+        width = mWidth;
+        height = mHeight;
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::createBuffer(const Cutlass::BufferInfo&, Cutlass::HBuffer& handle_out)
+    {
+        ++mStatistics.createBufferCount;
+        issue(handle_out);
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::writeBuffer(const size_t size, const void* const, const Cutlass::HBuffer&)
+    {
+        ++mStatistics.writeBufferCount;
+        mStatistics.writeBufferBytes += size;
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::destroyBuffer(const Cutlass::HBuffer&)
+    {
+        ++mStatistics.destroyBufferCount;
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::createTexture(const Cutlass::TextureInfo&, Cutlass::HTexture& handle_out)
+    {
+        ++mStatistics.createTextureCount;
+        issue(handle_out);
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::createTextureFromFile(const char*, Cutlass::HTexture& handle_out)
+    {
+        ++mStatistics.createTextureCount;
+        issue(handle_out);
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::getTextureSize(const Cutlass::HTexture&, uint32_t& width, uint32_t& height, uint32_t& depth)
+    {
+        width = mWidth;
+        height = mHeight;
+        depth = 1;
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::createRenderPass(const Cutlass::RenderPassInfo&, Cutlass::HRenderPass& handle_out)
+    {
+        ++mStatistics.createRenderPassCount;
+        issue(handle_out);
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::createGraphicsPipeline(const Cutlass::GraphicsPipelineInfo&, Cutlass::HGraphicsPipeline& handle_out)
+    {
+        ++mStatistics.createGraphicsPipelineCount;
+        issue(handle_out);
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::createCommandBuffer(const std::vector<Cutlass::CommandList>&, Cutlass::HCommandBuffer& handle_out)
+    {
+        ++mStatistics.createCommandBufferCount;
+        issue(handle_out);
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::createCommandBuffer(const Cutlass::CommandList&, Cutlass::HCommandBuffer& handle_out)
+    {
+        ++mStatistics.createCommandBufferCount;
+        issue(handle_out);
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::createSubCommandBuffer(const Cutlass::SubCommandList&, Cutlass::HCommandBuffer& handle_out)
+    {
+        ++mStatistics.createSubCommandBufferCount;
+        issue(handle_out);
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::updateCommandBuffer(const Cutlass::CommandList&, const Cutlass::HCommandBuffer&)
+    {
+        ++mStatistics.updateCommandBufferCount;
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::destroyCommandBuffer(const Cutlass::HCommandBuffer&)
+    {
+        ++mStatistics.destroyCommandBufferCount;
+        return Cutlass::Result::eSuccess;
+    }
+
+    Cutlass::Result NullRenderContext::execute(const Cutlass::HCommandBuffer&)
+    {
+        ++mStatistics.executeCount;
+        return Cutlass::Result::eSuccess;
+    }
+}
@@ -0,0 +1,230 @@
+#include <Lynx/System/PipelineCache.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <iostream>
+
+namespace Lynx
+{
+    namespace
+    {
+        constexpr const char* fileHeader = "LynxPipelineCache";
+        constexpr uint32_t fileVersion = 1;
+
+        template<typename Enum>
+        int toInt(Enum e)
+        {
+            return static_cast<int>(e);
+        }
+    }
+
+    PipelineCache::Key::Key(uint32_t pass_, Cutlass::DepthStencilState depthStencilState_, const Cutlass::RasterizerState& rasterizerState, Cutlass::Topology topology_)
+    : pass(pass_)
+    , depthStencilState(depthStencilState_)
+    , polygonMode(rasterizerState.polygonMode)
+    , cullMode(rasterizerState.cullMode)
+    , frontFace(rasterizerState.frontFace)
+    , lineWidth(rasterizerState.lineWidth)
+    , topology(topology_)
+    {
+
+    }
+
+    bool PipelineCache::Key::operator==(const Key& another) const
+    {
+        return pass == another.pass
+            && depthStencilState == another.depthStencilState
+            && polygonMode == another.polygonMode
+            && cullMode == another.cullMode
+            && frontFace == another.frontFace
+            && std::equal_to<float>()(lineWidth, another.lineWidth)
+            && topology == another.topology;
+    }
+
+    size_t PipelineCache::KeyHash::operator()(const Key& key) const
+    {
+        size_t seed = std::hash<uint32_t>()(key.pass);
+        auto combine = [&seed](size_t value)
+        {
+            seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        };
+
+        combine(std::hash<int>()(toInt(key.depthStencilState)));
+        combine(std::hash<int>()(toInt(key.polygonMode)));
+        combine(std::hash<int>()(toInt(key.cullMode)));
+        combine(std::hash<int>()(toInt(key.frontFace)));
+        combine(std::hash<float>()(key.lineWidth));
+        combine(std::hash<int>()(toInt(key.topology)));
+
+        return seed;
+    }
+
+    PipelineCache::PipelineCache(const std::shared_ptr<IRenderContext>& context)
+    : mContext(context)
+    , mHitCount(0)
+    , mMissCount(0)
+    {
+
+    }
+
+    PipelineCache::~PipelineCache()
+    {
+
+    }
+
+    uint32_t PipelineCache::addPass(const char* name, const Cutlass::Shader& vs, const Cutlass::Shader& fs, const Cutlass::HRenderPass& renderPass)
+    {
+        mPasses.push_back({std::string(name), vs, fs, renderPass});
+        return static_cast<uint32_t>(mPasses.size() - 1);
+    }
+
+    Cutlass::Result PipelineCache::get(const Key& key, Cutlass::HGraphicsPipeline& handle_out)
+    {
+        uint32_t id;
+        return get(key, handle_out, id);
+    }
+
+    Cutlass::Result PipelineCache::get(const Key& key, Cutlass::HGraphicsPipeline& handle_out, uint32_t& id_out)
+    {
+        if(key.pass >= mPasses.size())
+        {
+            assert(!"unregistered pipeline pass!");
+            return Cutlass::Result::eFailure;
+        }
+
+        const auto& itr = mPipelines.find(key);
+        if(itr != mPipelines.end())
+        {
+            ++mHitCount;
+            handle_out = itr->second.handle;
+            id_out = itr->second.id;
+            return Cutlass::Result::eSuccess;
+        }
+
+        const auto& pass = mPasses[key.pass];
+        Cutlass::GraphicsPipelineInfo gpi
+        (
+            pass.vs,
+            pass.fs,
+            pass.renderPass,
+            key.depthStencilState,
+            Cutlass::RasterizerState(key.polygonMode, key.cullMode, key.frontFace, key.lineWidth),
+            key.topology
+        );
+
+        Cutlass::HGraphicsPipeline pipeline;
+        Cutlass::Result result = mContext->createGraphicsPipeline(gpi, pipeline);
+        if(result != Cutlass::Result::eSuccess)
+            return result;
+
+        ++mMissCount;
+        id_out = static_cast<uint32_t>(mPipelines.size());
+        mPipelines.emplace(key, Entry{pipeline, id_out});
+        handle_out = pipeline;
+
+        return result;
+    }
+
+    bool PipelineCache::save(const char* path) const
+    {
+        std::ofstream ofs(path);
+        if(!ofs)
+        {
+            std::cerr << "failed to open pipeline cache file : " << path << "\n";
+            return false;
+        }
+
+        ofs << fileHeader << " " << fileVersion << "\n";
+        for(const auto& p : mPipelines)
+        {
+            const auto& key = p.first;
+            ofs << mPasses[key.pass].name << " "
+                << toInt(key.depthStencilState) << " "
+                << toInt(key.polygonMode) << " "
+                << toInt(key.cullMode) << " "
+                << toInt(key.frontFace) << " "
+                << key.lineWidth << " "
+                << toInt(key.topology) << "\n";
+        }
+
+        return static_cast<bool>(ofs);
+    }
+
+    bool PipelineCache::load(const char* path)
+    {
+        std::ifstream ifs(path);
+        if(!ifs)//初回起動時などは普通に無い
+            return false;
+
+        {
+            std::string header;
+            uint32_t version = 0;
+            ifs >> header >> version;
+            if(header != fileHeader || version != fileVersion)
+            {
+                std::cerr << "invalid pipeline cache file : " << path << "\n";
+                return false;
+            }
+        }
+
+        std::string line;
+        while(std::getline(ifs, line))
+        {
+            if(line.empty())
+                continue;
+
+            std::istringstream iss(line);
+            std::string name;
+            int depthStencilState, polygonMode, cullMode, frontFace, topology;
+            float lineWidth;
+            if(!(iss >> name >> depthStencilState >> polygonMode >> cullMode >> frontFace >> lineWidth >> topology))
+            {
+                std::cerr << "broken pipeline cache entry : " << line << "\n";
+                continue;
+            }
+
+            uint32_t pass = 0;
+            while(pass < mPasses.size() && mPasses[pass].name != name)
+                ++pass;
+
+            if(pass >= mPasses.size())//このRendererでは使っていないパス
+                continue;
+
+            Key key
+            (
+                pass,
+                static_cast<Cutlass::DepthStencilState>(depthStencilState),
+                Cutlass::RasterizerState
+                (
+                    static_cast<Cutlass::PolygonMode>(polygonMode),
+                    static_cast<Cutlass::CullMode>(cullMode),
+                    static_cast<Cutlass::FrontFace>(frontFace),
+                    lineWidth
+                ),
+                static_cast<Cutlass::Topology>(topology)
+            );
+
+            Cutlass::HGraphicsPipeline pipeline;
+            if(Cutlass::Result::eSuccess != get(key, pipeline))
+                std::cerr << "failed to create cached pipeline!\n";
+        }
+
+        return true;
+    }
+
+    size_t PipelineCache::size() const
+    {
+        return mPipelines.size();
+    }
+
+    uint64_t PipelineCache::getHitCount() const
+    {
+        return mHitCount;
+    }
+
+    uint64_t PipelineCache::getMissCount() const
+    {
+        return mMissCount;
+    }
+}
@@ -0,0 +1,95 @@
+#include <Lynx/System/RenderContext.hpp>
+
+namespace Lynx
+{
+    CutlassRenderContext::CutlassRenderContext(const std::shared_ptr<Cutlass::Context>& context)
+    : mContext(context)
+    {
+
+    }
+
+    CutlassRenderContext::~CutlassRenderContext()
+    {
+
+    }
+
+    const std::shared_ptr<Cutlass::Context>& CutlassRenderContext::getContext() const
+    {
+        return mContext;
+    }
+
+    Cutlass::Result CutlassRenderContext::getWindowSize(const Cutlass::HWindow& handle, uint32_t& width, uint32_t& height)
+    {
+        return mContext->getWindowSize(handle, width, height);
+    }
+
+    Cutlass::Result CutlassRenderContext::createBuffer(const Cutlass::BufferInfo& info, Cutlass::HBuffer& handle_out)
+    {
+        return mContext->createBuffer(info, handle_out);
+    }
+
+    Cutlass::Result CutlassRenderContext::writeBuffer(const size_t size, const void* const pData, const Cutlass::HBuffer& handle)
+    {
+        return mContext->writeBuffer(size, pData, handle);
+    }
+
+    Cutlass::Result CutlassRenderContext::destroyBuffer(const Cutlass::HBuffer& handle)
+    {
+        return mContext->destroyBuffer(handle);
+    }
+
+    Cutlass::Result CutlassRenderContext::createTexture(const Cutlass::TextureInfo& info, Cutlass::HTexture& handle_out)
+    {
+        return mContext->createTexture(info, handle_out);
+    }
+
+    Cutlass::Result CutlassRenderContext::createTextureFromFile(const char* path, Cutlass::HTexture& handle_out)
+    {
+        return mContext->createTextureFromFile(path, handle_out);
+    }
+
+    Cutlass::Result CutlassRenderContext::getTextureSize(const Cutlass::HTexture& handle, uint32_t& width, uint32_t& height, uint32_t& depth)
+    {
+        return mContext->getTextureSize(handle, width, height, depth);
+    }
+
+    Cutlass::Result CutlassRenderContext::createRenderPass(const Cutlass::RenderPassInfo& info, Cutlass::HRenderPass& handle_out)
+    {
+        return mContext->createRenderPass(info, handle_out);
+    }
+
+    Cutlass::Result CutlassRenderContext::createGraphicsPipeline(const Cutlass::GraphicsPipelineInfo& info, Cutlass::HGraphicsPipeline& handle_out)
+    {
+        return mContext->createGraphicsPipeline(info, handle_out);
+    }
+
+    Cutlass::Result CutlassRenderContext::createCommandBuffer(const std::vector<Cutlass::CommandList>& commandLists, Cutlass::HCommandBuffer& handle_out)
+    {
+        return mContext->createCommandBuffer(commandLists, handle_out);
+    }
+
+    Cutlass::Result CutlassRenderContext::createCommandBuffer(const Cutlass::CommandList& commandList, Cutlass::HCommandBuffer& handle_out)
+    {
+        return mContext->createCommandBuffer(commandList, handle_out);
+    }
+
+    Cutlass::Result CutlassRenderContext::createSubCommandBuffer(const Cutlass::SubCommandList& subCommandList, Cutlass::HCommandBuffer& handle_out)
+    {
+        return mContext->createSubCommandBuffer(subCommandList, handle_out);
+    }
+
+    Cutlass::Result CutlassRenderContext::updateCommandBuffer(const Cutlass::CommandList& commandList, const Cutlass::HCommandBuffer& handle)
+    {
+        return mContext->updateCommandBuffer(commandList, handle);
+    }
+
+    Cutlass::Result CutlassRenderContext::destroyCommandBuffer(const Cutlass::HCommandBuffer& handle)
+    {
+        return mContext->destroyCommandBuffer(handle);
+    }
+
+    Cutlass::Result CutlassRenderContext::execute(const Cutlass::HCommandBuffer& handle)
+    {
+        return mContext->execute(handle);
+    }
+}
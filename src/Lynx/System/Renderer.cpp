@@ -7,10 +7,19 @@
 #include <Lynx/Components/CameraComponent.hpp>
 #include <Lynx/Components/LightComponent.hpp>
 #include <Lynx/Components/SpriteComponent.hpp>
+#include <Lynx/Utility/RadixSort.hpp>
+#include <Lynx/System/FrameClock.hpp>
 
 #include <iostream>
+#include <cstring>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <thread>
 
 #include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/string_cast.hpp>
 
 using namespace Cutlass;
@@ -18,6 +27,52 @@ using namespace Cutlass;
 namespace Lynx
 {
 
+    //前回と内容が同じなら転送しない(バージョンを持たないボーン用)
+    template<typename T>
+    inline bool writeIfChanged(IRenderContext& context, const T& data, T& cache, bool cached, const HBuffer& handle)
+    {
+        if(cached && std::memcmp(&data, &cache, sizeof(T)) == 0)
+            return false;
+
+        cache = data;
+        context.writeBuffer(sizeof(T), &data, handle);
+        return true;
+    }
+
+    //ソートキーは上位からパイプライン12bit, マテリアル16bit, 形状16bit, 深度20bit
+    //IDがビット幅を超えると並びが少し悪くなるだけで、描画結果は変わらない
+    constexpr uint64_t sortKeyPipelineShift = 52;
+    constexpr uint64_t sortKeyMaterialShift = 36;
+    constexpr uint64_t sortKeyMeshShift = 20;
+    constexpr uint64_t sortKeyPipelineMask = (1ull << 12) - 1;
+    constexpr uint64_t sortKeyMaterialMask = (1ull << 16) - 1;
+    constexpr uint64_t sortKeyMeshMask = (1ull << 16) - 1;
+    constexpr uint64_t sortKeyDepthMask = (1ull << 20) - 1;
+
+    inline uint64_t makeSortKey(uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth)
+    {
+        return ((pipeline & sortKeyPipelineMask) << sortKeyPipelineShift)
+            | ((material & sortKeyMaterialMask) << sortKeyMaterialShift)
+            | ((mesh & sortKeyMeshMask) << sortKeyMeshShift)
+            | (depth & sortKeyDepthMask);
+    }
+
+    //各要素の表示状態を更新する, 前回と組み合わせが変わっていたらtrue
+    template<typename Info, typename Pred>
+    inline bool updateVisibility(std::vector<uint8_t>& visibility, const std::vector<Info>& infos, Pred pred)
+    {
+        bool changed = visibility.size() != infos.size();
+        visibility.resize(infos.size());
+        for(size_t i = 0; i < infos.size(); ++i)
+        {
+            const uint8_t visible = pred(infos[i]) ? 1 : 0;
+            changed |= visibility[i] != visible;
+            visibility[i] = visible;
+        }
+
+        return changed;
+    }
+
     inline glm::vec3 rotate2D(const glm::vec3& vec, const float cosine, const float sine)
     {
         glm::vec3 out = vec;
@@ -28,16 +83,39 @@ namespace Lynx
 
 
     Renderer::Renderer(std::shared_ptr<Context> context, const std::vector<HWindow>& hwindows, const uint16_t frameBufferNum)
+    : Renderer(std::make_shared<CutlassRenderContext>(context), hwindows, frameBufferNum)
+    {
+
+    }
+
+    Renderer::Renderer(std::shared_ptr<IRenderContext> context, const std::vector<HWindow>& hwindows, const uint16_t frameBufferNum)
     : mContext(context)
     , mHWindows(hwindows)
     , mFrameCount(frameBufferNum)
-    , mSceneBuilded(false)
+    , mPipelineCache(std::make_unique<PipelineCache>(context))
+    , mMeshRegistry(std::make_unique<MeshRegistry>(context))
+    , mCameraVersion(0)
+    , mNextSerial(0)
     , mShadowAdded(false)
     , mGeometryAdded(true)
     , mLightingAdded(false)
     , mForwardAdded(false)
     , mPostEffectAdded(false)
     , mSpriteAdded(false)
+    , mSceneBuilded(false)
+    , mRebuildWindowStart(std::chrono::steady_clock::now())
+    , mRebuildCountInWindow(0)
+    , mRebuildsPerSecond(0)
+    , mFrustumCulling(true)
+    , mShadowCasterCulling(true)
+    , mShadowFitToCamera(false)
+    , mShadowDistance(100.f)
+    , mShadowVersion(0)
+    , mDepthSort(true)
+    , mRecordThreadCount(1)
+    , mRecordChunkSize(16)
+    , mJobSystem(nullptr)
+    , mStatistics()
     {
         assert(Result::eSuccess == mContext->createTextureFromFile("Resources/textures/texture.png", mDebugTex));
         //assert(Result::eSuccess == mContext->createTextureFromFile("Resources/textures/unitysky.png", mDebugSky));
@@ -75,6 +153,8 @@ namespace Lynx
 
              if(Result::eSuccess != mContext->createRenderPass(RenderPassInfo(mShadowMap), mShadowPass))
                 assert(!"failed to create shadow renderpass!");
+
+            mShadowPipelinePass = mPipelineCache->addPass("shadow", mShadowVS, mShadowFS, mShadowPass);
         }
 
         {//G-Buffer 構築
@@ -93,6 +173,8 @@ namespace Lynx
                 assert(!"failed to create G-Buffer renderpass!");
             }
 
+            mGeometryPipelinePass = mPipelineCache->addPass("geometry", mDefferedSkinVS, mDefferedSkinFS, mGBuffer.renderPass);
+
             // {
             //     GraphicsPipelineInfo gpi
             //     (
@@ -220,6 +302,15 @@ namespace Lynx
         //mContext->createCommandBuffer(cl, mForwardCB);
         //mContext->createCommandBuffer(cl, mPostEffectCB);
         
+        {//ボーンを使わないものは全員で1つ
+            BoneData data;
+            BufferInfo bi;
+            bi.setUniformBuffer<BoneData>();
+            if(Result::eSuccess != mContext->createBuffer(bi, mNoBoneUB))
+                assert(!"failed to create bone UB!");
+            mContext->writeBuffer(sizeof(BoneData), &data, mNoBoneUB);
+        }
+
         {//カメラ用バッファを作成しておく
             BufferInfo bi;
             bi.setUniformBuffer<CameraData>();
@@ -349,66 +440,28 @@ namespace Lynx
         }
 
         const std::shared_ptr<MeshComponent>& mesh_ = mesh.lock();
-        const std::shared_ptr<MaterialComponent>& material_ = material.lock();
 
         auto& tmp = mRenderInfos.emplace_back();
         tmp.skeletal = false;
+        tmp.castShadow = castShadow;
         tmp.receiveShadow = receiveShadow;
         tmp.lighting = lighting;
         tmp.mesh = mesh;
         tmp.material = material;
-
-        if(castShadow)
-        {//シャドウマップ用パス
-        
-            GraphicsPipelineInfo gpi
-            (
-                mShadowVS,
-                mShadowFS,
-                mShadowPass,
-                DepthStencilState::eDepth,
-                mesh_->getRasterizerState(),
-                mesh_->getTopology()
-            );
-
-            if(Cutlass::Result::eSuccess != mContext->createGraphicsPipeline(gpi, tmp.shadowPipeline))
-                assert(!"failed to create shadow pipeline");
-        }
-
-        {
-            GraphicsPipelineInfo gpi
-            (
-                mDefferedSkinVS,
-                mDefferedSkinFS,
-                mGBuffer.renderPass,
-                DepthStencilState::eDepth,
-                mesh_->getRasterizerState(),
-                mesh_->getTopology()
-            );
-    
-            if(Cutlass::Result::eSuccess != mContext->createGraphicsPipeline(gpi, tmp.geometryPipeline))
-                assert(!"failed to create geometry pipeline");
-        }
-
-        std::cerr << "1\n";
-
-        //頂点バッファ、インデックスバッファ構築
+        tmp.boneUB = mNoBoneUB;
+        tmp.sceneTransformVersion = tmp.sceneCameraVersion = 0;
+        tmp.shadowLightVersion = tmp.shadowTransformVersion = 0;
+        tmp.boneCached = false;
+        tmp.boundsVersion = 0;
+        tmp.inFrustum = true;
+        tmp.inShadowFrustum = true;
+        tmp.serial = mNextSerial++;
+
+        //頂点バッファ、インデックスバッファ(同じ形状なら共有される)
         for(const auto& m : mesh_->getMeshes())
-        {
-            Cutlass::HBuffer VB, IB;
-            Cutlass::BufferInfo bi;
-            bi.setVertexBuffer<MeshComponent::Vertex>(m.vertices.size());
-            mContext->createBuffer(bi, VB);
-            mContext->writeBuffer(m.vertices.size() * sizeof(MeshComponent::Vertex), m.vertices.data(), VB);
-            tmp.VBs.emplace_back(VB);
-            
-            bi.setIndexBuffer<uint32_t>(m.indices.size());
-            mContext->createBuffer(bi, IB);
-            mContext->writeBuffer(m.indices.size() * sizeof(uint32_t), m.indices.data(), IB);
-            tmp.IBs.emplace_back(IB);
-        }
+            tmp.meshes.emplace_back(mMeshRegistry->acquire(m));
 
-        //定数バッファ構築
+        //定数バッファ構築(ボーンは使わないので共有のもの)
         {
             Cutlass::BufferInfo bi;
             {//WVP
@@ -416,93 +469,18 @@ namespace Lynx
                 mContext->createBuffer(bi, tmp.sceneUB);
             }
 
-            {//ボーン
-                //注意 : いまのところおいとく
-                BoneData data;
-
-                bi.setUniformBuffer<BoneData>();
-                mContext->createBuffer(bi, tmp.boneUB);
-                mContext->writeBuffer(sizeof(BoneData), &data, tmp.boneUB);
-            }
-
             {
                 bi.setUniformBuffer<ShadowData>();
                 mContext->createBuffer(bi, tmp.shadowUB);
             }
-
         }
 
-        {//コマンド作成
-
-            //シャドウパス
-            if(castShadow)
-            {
-                ShaderResourceSet bufferSet;
-                {
-                    bufferSet.bind(0, tmp.sceneUB);
-                    bufferSet.bind(1, tmp.shadowUB);
-                    bufferSet.bind(2, tmp.boneUB);
-                }
-
-                SubCommandList scl(mShadowPass);
-                scl.bind(tmp.shadowPipeline);
-
-                scl.bind(0, bufferSet);
-                assert(tmp.VBs.size() == tmp.IBs.size());
-                for(size_t i = 0; i < tmp.VBs.size(); ++i)
-                {
-                    scl.bind(tmp.VBs[i], tmp.IBs[i]);
-                    scl.renderIndexed(mesh_->getMeshes()[i].indices.size(), 1, 0, 0, 0);
-                }
-
-                //HCommandBuffer cb;
-                if(Cutlass::Result::eSuccess != mContext->createSubCommandBuffer(scl, tmp.shadowSubCB))
-                    assert(!"failed to create command buffer!");
-                //mShadowSubs.emplace_back(cb);
-            }
-
-            //ジオメトリパス
-            {
-                ShaderResourceSet bufferSet;
-                ShaderResourceSet textureSet;
-                {
-                    bufferSet.bind(0, tmp.sceneUB);
-                    // if(!material->getMaterialSets().empty())
-                    //     bufferSet.bind(1, material->getMaterialSets().back().paramBuffer);
-                    // else
-                    // {
-                    //     //マテリアル読む
-                    // }
-                    bufferSet.bind(1, tmp.boneUB);
-
-                    auto&& textures = material_->getTextures();
-
-                    if(textures.empty())
-                        textureSet.bind(0, mDebugTex);
-                    else
-                        textureSet.bind(0, textures.back().handle);
-                }
-
-                SubCommandList scl(mGBuffer.renderPass);
-                scl.bind(tmp.geometryPipeline);
-                scl.bind(0, bufferSet);
-                scl.bind(1, textureSet);
-
-                for(size_t i = 0; i < tmp.VBs.size(); ++i)
-                {
-                    scl.bind(tmp.VBs[i], tmp.IBs[i]);
-                    scl.renderIndexed(mesh_->getMeshes()[i].indices.size(), 1, 0, 0, 0);
-                }
-
-                HCommandBuffer cb;
-                if(Cutlass::Result::eSuccess != mContext->createSubCommandBuffer(scl, tmp.geometrySubCB))
-                    assert(!"failed to create command buffer!");
-                //mGeometrySubs.emplace_back(cb);
-            }
-        }
+        //同じ形状・パイプライン・マテリアルのものとまとめて描く
+        assignBatch(tmp, *mesh_);
         
         //影コントロール実装時注意
-        mShadowAdded = true;
+        if(castShadow)
+            mShadowAdded = true;
         mGeometryAdded = true;
         //std::cerr << "registed\n";
     }
@@ -525,33 +503,26 @@ namespace Lynx
 
         auto& tmp = mRenderInfos.emplace_back();
         tmp.skeletal = true;
+        tmp.castShadow = castShadow;
         tmp.receiveShadow = receiveShadow;
         tmp.lighting = lighting;
         tmp.mesh = static_cast<std::shared_ptr<MeshComponent>>(skeletalMesh);
         tmp.skeletalMesh = skeletalMesh;
         tmp.material = material;
+        tmp.sceneTransformVersion = tmp.sceneCameraVersion = 0;
+        tmp.shadowLightVersion = tmp.shadowTransformVersion = 0;
+        tmp.boneCached = false;
+        tmp.boundsVersion = 0;
+        tmp.inFrustum = true;
+        tmp.inShadowFrustum = true;
+        tmp.serial = mNextSerial++;
+        tmp.boneCache = std::make_unique<BoneData>();
 
         const auto& skeletalMesh_ = skeletalMesh.lock();
-        const auto& material_ = material.lock();
-
-       //頂点バッファ、インデックスバッファ構築
-        for(const auto& m : skeletalMesh_->getMeshes())
-        {
-            auto&& vb = tmp.VBs.emplace_back();
-            Cutlass::BufferInfo bi;
-            bi.setVertexBuffer<MeshComponent::Vertex>(m.vertices.size());
-            mContext->createBuffer(bi, vb);
-            mContext->writeBuffer(m.vertices.size() * sizeof(MeshComponent::Vertex), m.vertices.data(), vb);
-        }
 
+        //頂点バッファ、インデックスバッファ構築
         for(const auto& m : skeletalMesh_->getMeshes())
-        {
-            auto&& ib = tmp.IBs.emplace_back();
-            Cutlass::BufferInfo bi;
-            bi.setIndexBuffer<uint32_t>(m.indices.size());
-            mContext->createBuffer(bi, ib);
-            mContext->writeBuffer(m.indices.size() * sizeof(uint32_t), m.indices.data(), ib);
-        }
+            tmp.meshes.emplace_back(mMeshRegistry->acquire(m));
 
         //定数バッファ構築
         {
@@ -564,7 +535,6 @@ namespace Lynx
             {//ボーン
                 bi.setUniformBuffer<BoneData>();
                 mContext->createBuffer(bi, tmp.boneUB);
-                //mContext->writeBuffer(sizeof(BoneData), &data, tmp.boneUB);
             }
 
             {
@@ -573,112 +543,424 @@ namespace Lynx
             }
         }
 
+        //ボーンはオブジェクトごとの定数バッファなので、スケルタルメッシュも同じようにまとめられる
+        assignBatch(tmp, *skeletalMesh_);
+
+        //影コントロール実装時注意
         if(castShadow)
-        {//シャドウマップ用パス
-            GraphicsPipelineInfo gpi
-            (
-                mShadowVS,
-                mShadowFS,
-                mShadowPass,
-                DepthStencilState::eDepth,
-                skeletalMesh_->getRasterizerState(),
-                skeletalMesh_->getTopology()
-            );
+            mShadowAdded = true;
+        mGeometryAdded = true;
+    }
+
+    size_t Renderer::BatchKeyHash::operator()(const BatchKey& key) const
+    {
+        size_t seed = std::hash<uint32_t>()(key.material);
+        auto combine = [&seed](size_t value)
+        {
+            seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        };
+
+        combine(std::hash<uint32_t>()(key.geometryPipeline));
+        combine(std::hash<uint32_t>()(key.shadowPipeline));
+        for(const auto& mesh : key.meshes)
+            combine(std::hash<uint32_t>()(mesh));
+
+        return seed;
+    }
+
+    bool Renderer::BatchKey::operator==(const BatchKey& another) const
+    {
+        return material == another.material
+            && geometryPipeline == another.geometryPipeline
+            && shadowPipeline == another.shadowPipeline
+            && meshes == another.meshes;
+    }
+
+    void Renderer::assignBatch(RenderInfo& ri, const MeshComponent& mesh)
+    {
+        BatchKey key;
+        key.meshes = ri.meshes;
+        key.material = ri.material.lock()->getID();
+        key.shadowPipeline = UINT32_MAX;
+
+        Cutlass::HGraphicsPipeline geometryPipeline;
+        Cutlass::HGraphicsPipeline shadowPipeline;
 
-            if(Cutlass::Result::eSuccess != mContext->createGraphicsPipeline(gpi, tmp.shadowPipeline))
+        if(ri.castShadow)
+        {//シャドウマップ用パス
+            const PipelineCache::Key pk(mShadowPipelinePass, DepthStencilState::eDepth, mesh.getRasterizerState(), mesh.getTopology());
+            if(Cutlass::Result::eSuccess != mPipelineCache->get(pk, shadowPipeline, key.shadowPipeline))
                 assert(!"failed to create shadow pipeline");
         }
 
         {
-            GraphicsPipelineInfo gpi
-            (
-                mDefferedSkinVS,
-                mDefferedSkinFS,
-                mGBuffer.renderPass,
-                DepthStencilState::eDepth,
-                skeletalMesh_->getRasterizerState(),
-                skeletalMesh_->getTopology()
-            );
-    
-            if(Cutlass::Result::eSuccess != mContext->createGraphicsPipeline(gpi, tmp.geometryPipeline))
+            const PipelineCache::Key pk(mGeometryPipelinePass, DepthStencilState::eDepth, mesh.getRasterizerState(), mesh.getTopology());
+            if(Cutlass::Result::eSuccess != mPipelineCache->get(pk, geometryPipeline, key.geometryPipeline))
                 assert(!"failed to create geometry pipeline");
         }
 
-        
-        {//コマンド作成
-
-            //シャドウパス
-            if(castShadow)
+        {//既にある
+            const auto& itr = mBatchIndices.find(key);
+            if(itr != mBatchIndices.end())
             {
-                ShaderResourceSet bufferSet;
-                {
-                    bufferSet.bind(0, tmp.sceneUB);
-                    bufferSet.bind(1, tmp.shadowUB);
-                    bufferSet.bind(2, tmp.boneUB);
-                }
+                ri.batch = itr->second;
+                ++mBatches[ri.batch].refCount;
+                return;
+            }
+        }
 
-                SubCommandList scl(mShadowPass);
-                scl.bind(tmp.shadowPipeline);
+        if(mFreeBatches.empty())
+        {
+            ri.batch = static_cast<uint32_t>(mBatches.size());
+            mBatches.emplace_back();
+        }
+        else
+        {
+            ri.batch = mFreeBatches.back();
+            mFreeBatches.pop_back();
+        }
 
-                scl.bind(0, bufferSet);
-                assert(tmp.VBs.size() == tmp.IBs.size());
-                for(size_t i = 0; i < tmp.VBs.size(); ++i)
-                {
-                    scl.bind(tmp.VBs[i], tmp.IBs[i]);
-                    scl.renderIndexed(skeletalMesh_->getMeshes()[i].indices.size(), 1, 0, 0, 0);
-                }
+        auto& batch = mBatches[ri.batch];
+        batch.key = key;
+        batch.shadowPipeline = shadowPipeline;
+        batch.geometryPipeline = geometryPipeline;
+        batch.material = ri.material;
+        batch.refCount = 1;
+        for(uint32_t pass = 0; pass < Batch::ePassNum; ++pass)
+        {
+            batch.pending[pass].clear();
+            batch.recorded[pass].clear();
+            batch.hasSubCB[pass] = false;
+            batch.drawCount[pass] = 0;
+        }
+        batch.dirty = true;
+
+        mBatchIndices.emplace(key, ri.batch);
+    }
+
+    void Renderer::releaseBatch(uint32_t index)
+    {
+        auto& batch = mBatches[index];
+        assert(batch.refCount > 0);
+        if(--batch.refCount > 0)
+            return;
+
+        for(uint32_t pass = 0; pass < Batch::ePassNum; ++pass)
+        {
+            if(batch.hasSubCB[pass])
+                mContext->destroyCommandBuffer(batch.subCB[pass]);
+            batch.hasSubCB[pass] = false;
+            batch.pending[pass].clear();
+            batch.recorded[pass].clear();
+        }
+
+        mBatchIndices.erase(batch.key);
+        batch.material.reset();
+        mFreeBatches.emplace_back(index);
+    }
 
-                //HCommandBuffer cb;
-                if(Cutlass::Result::eSuccess != mContext->createSubCommandBuffer(scl, tmp.shadowSubCB))
-                    assert(!"failed to create command buffer!");
-                //mShadowSubs.emplace_back(cb);
+    bool Renderer::updateBatch(Batch& batch, uint32_t pass)
+    {
+        //前回記録したときと同じメンバーなら何もしない
+        auto& pending = batch.pending[pass];
+        auto& recorded = batch.recorded[pass];
+        bool changed = batch.dirty || pending.size() != recorded.size();
+        for(size_t i = 0; i < pending.size() && !changed; ++i)
+            changed = mRenderInfos[pending[i]].serial != recorded[i];
+
+        if(!changed)
+            return false;
+
+        recorded.resize(pending.size());
+        for(size_t i = 0; i < pending.size(); ++i)
+            recorded[i] = mRenderInfos[pending[i]].serial;
+
+        if(batch.hasSubCB[pass])
+            mContext->destroyCommandBuffer(batch.subCB[pass]);
+        batch.hasSubCB[pass] = false;
+
+        return true;
+    }
+
+    uint32_t Renderer::recordBatch(const Batch& batch, uint32_t pass, SubCommandList& scl) const
+    {
+        const auto& pending = batch.pending[pass];
+
+        //形状は全員同じ
+        std::vector<MeshRegistry::Geometry> geometries;
+        geometries.reserve(batch.key.meshes.size());
+        for(const auto& handle : batch.key.meshes)
+            geometries.emplace_back(mMeshRegistry->get(handle));
+
+        const bool shadow = pass == Batch::eShadowPass;
+        scl.bind(shadow ? batch.shadowPipeline : batch.geometryPipeline);
+
+        if(!shadow)
+        {
+            ShaderResourceSet textureSet;
+            const auto& material = batch.material.lock();
+            if(!material || material->getTextures().empty())
+                textureSet.bind(0, mDebugTex);
+            else
+                textureSet.bind(0, material->getTextures().back().handle);
+            scl.bind(1, textureSet);
+        }
+
+        //パイプライン、テクスチャ、頂点バッファは1回だけバインドして、オブジェクトごとの定数バッファだけ差し替えて描く
+        uint32_t draws = 0;
+        uint32_t boundPage = UINT32_MAX;
+        for(const auto& index : pending)
+        {
+            const auto& ri = mRenderInfos[index];
+
+            ShaderResourceSet bufferSet;
+            if(shadow)
+            {
+                bufferSet.bind(0, ri.sceneUB);
+                bufferSet.bind(1, ri.shadowUB);
+                bufferSet.bind(2, ri.boneUB);
             }
+            else
+            {
+                bufferSet.bind(0, ri.sceneUB);
+                bufferSet.bind(1, ri.boneUB);
+            }
+            scl.bind(0, bufferSet);
 
-            //ジオメトリパス
+            for(const auto& geometry : geometries)
             {
-                ShaderResourceSet bufferSet;
-                ShaderResourceSet textureSet;
+                if(geometry.page != boundPage)
                 {
-                    bufferSet.bind(0, tmp.sceneUB);
-                    // if(!material->getMaterialSets().empty())
-                    //     bufferSet.bind(1, material->getMaterialSets().back().paramBuffer);
-                    // else
-                    // {
-                    //     //マテリアル読む
-                    // }
-                    bufferSet.bind(1, tmp.boneUB);
-
-                    auto&& textures = material_->getTextures();
-                    
-                    if(textures.empty())
-                        textureSet.bind(0, mDebugTex);
-                    else
-                        textureSet.bind(0, textures.back().handle);
+                    scl.bind(geometry.VB, geometry.IB);
+                    boundPage = geometry.page;
                 }
+                scl.renderIndexed(geometry.indexCount, 1, geometry.firstIndex, static_cast<int32_t>(geometry.vertexOffset), 0);
+                ++draws;
+            }
+        }
 
-                SubCommandList scl(mGBuffer.renderPass);
-                scl.bind(tmp.geometryPipeline);
-                scl.bind(0, bufferSet);
-                scl.bind(1, textureSet);
-                // scl.bind(tmp.VB, tmp.IB);
-                // scl.renderIndexed(mesh_->getIndexNum(), 1, 0, 0, 0);
-                assert(tmp.VBs.size() == tmp.IBs.size());
-                for(size_t i = 0; i < tmp.VBs.size(); ++i)
-                {
-                    scl.bind(tmp.VBs[i], tmp.IBs[i]);
-                    scl.renderIndexed(skeletalMesh_->getMeshes()[i].indices.size(), 1, 0, 0, 0);
-                }
+        return draws;
+    }
+
+    void Renderer::recordBatches()
+    {
+        //記録が必要なものを集める
+        mRecordJobs.clear();
+        for(uint32_t i = 0; i < mBatches.size(); ++i)
+        {
+            auto& batch = mBatches[i];
+            if(batch.refCount == 0)
+                continue;
+
+            for(uint32_t pass = 0; pass < Batch::ePassNum; ++pass)
+                if(updateBatch(batch, pass))
+                    mRecordJobs.push_back({i, pass, 0, nullptr});
 
-                HCommandBuffer cb;
-                if(Cutlass::Result::eSuccess != mContext->createSubCommandBuffer(scl, tmp.geometrySubCB))
-                    assert(!"failed to create command buffer!");
-                //mGeometrySubs.emplace_back(cb);
+            batch.dirty = false;
+        }
+
+        auto record = [this](size_t begin, size_t end)
+        {
+            for(size_t i = begin; i < end; ++i)
+            {
+                auto& job = mRecordJobs[i];
+                if(mBatches[job.batch].pending[job.pass].empty())
+                    continue;
+
+                job.list = std::make_unique<SubCommandList>(job.pass == Batch::eShadowPass ? mShadowPass : mGBuffer.renderPass);
+                job.drawCount = recordBatch(mBatches[job.batch], job.pass, *job.list);
             }
+        };
+
+        //SubCommandListはCPU側のコマンドの列なので、組み立てだけをワーカーで並列に行う
+        //Vulkanのコマンドバッファへの記録はcreateSubCommandBuffer()の中で行われるが、
+        //Cutlassはスレッドごとのコマンドプールを公開しておらずスレッドセーフでもないので、呼び出し側のスレッドで順番に
+        if(!mJobSystem || mRecordThreadCount <= 1)
+            record(0, mRecordJobs.size());
+        else
+        {
+            const size_t grain = std::max<size_t>(mRecordChunkSize, (mRecordJobs.size() + mRecordThreadCount - 1) / mRecordThreadCount);
+            mJobSystem->parallelFor(0, mRecordJobs.size(), grain, record);
         }
 
-        //影コントロール実装時注意
-        mShadowAdded = castShadow;
-        mGeometryAdded = true;
+        for(auto& job : mRecordJobs)
+        {
+            if(!job.list)//空になった
+                continue;
+
+            auto& batch = mBatches[job.batch];
+            if(Cutlass::Result::eSuccess != mContext->createSubCommandBuffer(*job.list, batch.subCB[job.pass]))
+                assert(!"failed to create command buffer!");
+            else
+                batch.hasSubCB[job.pass] = true;
+            batch.drawCount[job.pass] = job.drawCount;
+
+            job.list.reset();
+        }
+    }
+
+    void Renderer::updateWorldBounds(RenderInfo& ri, const glm::mat4& world)
+    {
+        //スキニングで境界がバインドポーズから外れるので、スケルタルメッシュはカリングしない
+        if(ri.skeletal)
+        {
+            ri.worldCenter = glm::vec3(0);
+            ri.worldRadius = std::numeric_limits<float>::infinity();
+            return;
+        }
+
+        const auto& bounds = ri.mesh.lock()->getBounds();
+        ri.worldCenter = glm::vec3(world * glm::vec4(bounds.center, 1.f));
+
+        //非一様スケールでも包めるように一番大きい軸で
+        const float scale = std::max({glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))});
+        ri.worldRadius = bounds.radius * scale;
+    }
+
+    void Renderer::cull(const glm::mat4& viewProj)
+    {
+        mCuller.clear();
+        mCuller.reserve(mRenderInfos.size());
+        for(const auto& ri : mRenderInfos)
+            mCuller.add(ri.worldCenter, ri.worldRadius);
+
+        uint32_t visible = static_cast<uint32_t>(mRenderInfos.size());
+        if(mFrustumCulling)
+            visible = mCuller.cull(Frustum::fromMatrix(viewProj), mCullResult, mJobSystem);
+        else
+            mCullResult.assign(mRenderInfos.size(), 1);
+
+        for(size_t i = 0; i < mRenderInfos.size(); ++i)
+            mRenderInfos[i].inFrustum = mCullResult[i] != 0;
+
+        mStatistics.visibleCount = visible;
+        mStatistics.culledCount = static_cast<uint32_t>(mRenderInfos.size()) - visible;
+    }
+
+    void Renderer::cullShadowCasters(LightComponent& light, const glm::mat4& lightViewProj)
+    {
+        uint32_t casters = 0;
+        uint32_t culled = 0;
+
+        if(!mShadowCasterCulling)
+            mCullResult.assign(mRenderInfos.size(), 1);
+        else if(light.getType() == LightComponent::LightType::eDirectionalLight)
+            mCuller.cull(Frustum::fromMatrix(lightViewProj), mCullResult, mJobSystem);//cull()で積んだ境界球をそのまま使う
+        else
+        {//点光源はオブジェクトごとにビューを作るので、届く範囲かどうかだけ見る
+            const glm::vec3 lightPos(light.getTransform().getWorldMatrix()[3]);
+            mCullResult.resize(mRenderInfos.size());
+            for(size_t i = 0; i < mRenderInfos.size(); ++i)
+                mCullResult[i] = glm::length(mRenderInfos[i].worldCenter - lightPos) - mRenderInfos[i].worldRadius <= light.getRange() ? 1 : 0;
+        }
+
+        for(size_t i = 0; i < mRenderInfos.size(); ++i)
+        {
+            auto& ri = mRenderInfos[i];
+            ri.inShadowFrustum = mCullResult[i] != 0;
+            if(!ri.castShadow)
+                continue;
+
+            ++casters;
+            if(!ri.inShadowFrustum)
+                ++culled;
+        }
+
+        mStatistics.shadowCasterCount = casters - culled;
+        mStatistics.shadowCulledCount = culled;
+    }
+
+    void Renderer::fitShadowToCamera(const CameraComponent& camera, const glm::vec3& lightDir, glm::mat4& view_out, glm::mat4& proj_out) const
+    {
+        //影を出す距離までのカメラの視錐台の8頂点
+        const auto& pos = camera.getTransform().getPos();
+        const glm::vec3 forward = glm::normalize(camera.getLookAt() - pos);
+        const glm::vec3 right = glm::normalize(glm::cross(forward, camera.getUpDir()));
+        const glm::vec3 up = glm::cross(right, forward);
+        const float distances[2] = {camera.getNear(), std::min(camera.getFar(), mShadowDistance)};
+
+        glm::vec3 corners[8];
+        glm::vec3 center(0);
+        for(int i = 0; i < 2; ++i)
+        {
+            const float h = std::tan(camera.getFovY() * 0.5f) * distances[i];
+            const float w = h * camera.getAspect();
+            const glm::vec3 c = pos + forward * distances[i];
+            corners[i * 4 + 0] = c - right * w - up * h;
+            corners[i * 4 + 1] = c + right * w - up * h;
+            corners[i * 4 + 2] = c - right * w + up * h;
+            corners[i * 4 + 3] = c + right * w + up * h;
+        }
+
+        for(const auto& corner : corners)
+            center += corner;
+        center /= 8.f;
+
+        //球で包むとカメラが回転しても大きさが変わらないので影がちらつかない
+        float radius = 0;
+        for(const auto& corner : corners)
+            radius = std::max(radius, glm::length(corner - center));
+
+        //視錐台の外からも影が落ちてくるので、ライト側にもう一つ分伸ばす
+        const glm::vec3 lightUp = std::abs(lightDir.y) > 0.99f ? glm::vec3(0, 0, 1.f) : glm::vec3(0, 1.f, 0);
+        view_out = glm::lookAtRH(center - lightDir * (radius * 2.f), center, lightUp);
+        proj_out = glm::ortho(-radius, radius, -radius, radius, 0.f, radius * 3.f);
+        proj_out[1][1] *= -1;
+    }
+
+    void Renderer::setShadowCasterCulling(bool flag)
+    {
+        mShadowCasterCulling = flag;
+    }
+
+    void Renderer::setShadowFitToCamera(bool flag, float shadowDistance)
+    {
+        mShadowFitToCamera = flag;
+        mShadowDistance = shadowDistance;
+        mShadowVersion = 0;
+    }
+
+    void Renderer::setFrustumCulling(bool flag)
+    {
+        mFrustumCulling = flag;
+    }
+
+    void Renderer::setDepthSort(bool flag)
+    {
+        mDepthSort = flag;
+    }
+
+    void Renderer::setRecordThreadCount(uint32_t count)
+    {
+        mRecordThreadCount = count == 0 ? std::max(1u, std::thread::hardware_concurrency()) : count;
+
+        //JobSystemが渡されていなければ自前で持つ
+        if(mRecordThreadCount > 1 && !mJobSystem)
+        {
+            mOwnedJobSystem = std::make_unique<JobSystem>(mRecordThreadCount - 1);
+            mJobSystem = mOwnedJobSystem.get();
+        }
+    }
+
+    void Renderer::setJobSystem(JobSystem* jobSystem)
+    {
+        mJobSystem = jobSystem;
+        mOwnedJobSystem.reset();
+    }
+
+    void Renderer::destroyRenderInfo(RenderInfo& ri)
+    {
+        //形状は他のRenderInfoと共有している場合があるので参照を返すだけ
+        for(const auto& handle : ri.meshes)
+            mMeshRegistry->release(handle);
+        ri.meshes.clear();
+
+        mContext->destroyBuffer(ri.sceneUB);
+        mContext->destroyBuffer(ri.shadowUB);
+        if(ri.skeletal)
+            mContext->destroyBuffer(ri.boneUB);
+
+        releaseBatch(ri.batch);
     }
 
     //Sprite
@@ -763,6 +1045,7 @@ namespace Lynx
         mLights.emplace_back(light);
 
         mLightingAdded = true;
+        mShadowAdded = true;
     }
 
     void Renderer::setCamera(const std::weak_ptr<CameraComponent>& camera)
@@ -789,23 +1072,7 @@ namespace Lynx
         {
             if(ri.mesh.lock() == mesh.lock())
             {
-                // if(ri.mesh)
-                //     ri.mesh.reset();
-                // if(ri.skeletalMesh)
-                //     ri.skeletalMesh.reset();
-                // if(ri.material)
-                //     ri.material.reset();
-
-                for(auto& vb : ri.VBs)
-                    mContext->destroyBuffer(vb);
-                for(auto& ib : ri.IBs)
-                    mContext->destroyBuffer(ib);
-                mContext->destroyBuffer(ri.sceneUB);
-                mContext->destroyBuffer(ri.shadowUB);
-                mContext->destroyBuffer(ri.boneUB);
-
-                mContext->destroyCommandBuffer(ri.shadowSubCB);
-                mContext->destroyCommandBuffer(ri.geometrySubCB);
+                destroyRenderInfo(ri);
                 mShadowAdded = mGeometryAdded = true;
                 return true;
             }
@@ -827,23 +1094,7 @@ namespace Lynx
         {
             if(ri.mesh.lock() == skeletalMesh.lock() || ri.skeletalMesh.lock() == skeletalMesh.lock())
             {
-                // if(ri.mesh)
-                //     ri.mesh.reset();
-                // if(ri.skeletalMesh)
-                //     ri.skeletalMesh.reset();
-                // if(ri.material)
-                //     ri.material.reset();
-
-                for(auto& vb : ri.VBs)
-                    mContext->destroyBuffer(vb);
-                for(auto& ib : ri.IBs)
-                    mContext->destroyBuffer(ib);
-                mContext->destroyBuffer(ri.sceneUB);
-                mContext->destroyBuffer(ri.shadowUB);
-                mContext->destroyBuffer(ri.boneUB);
-
-                mContext->destroyCommandBuffer(ri.shadowSubCB);
-                mContext->destroyCommandBuffer(ri.geometrySubCB);
+                destroyRenderInfo(ri);
                 mShadowAdded = mGeometryAdded = true;
                 return true;
             }
@@ -891,27 +1142,7 @@ namespace Lynx
         mLights.clear();
 
         for(auto& ri : mRenderInfos)
-        {
-            // if(ri.mesh)
-            //     ri.mesh.reset();
-            // if(ri.skeletalMesh)
-            //     ri.skeletalMesh.reset();
-            // if(ri.material)
-            //     ri.material.reset();
-
-            for(auto& vb : ri.VBs)
-                mContext->destroyBuffer(vb);
-            for(auto& ib : ri.IBs)
-                mContext->destroyBuffer(ib);
-            mContext->destroyBuffer(ri.sceneUB);
-            mContext->destroyBuffer(ri.shadowUB);
-            mContext->destroyBuffer(ri.boneUB);
-            // mContext->destroyGraphicsPipeline(ri.geometryPipeline);
-            // mContext->destroyGraphicsPipeline(ri.shadowPipeline);
-
-            mContext->destroyCommandBuffer(ri.shadowSubCB);
-            mContext->destroyCommandBuffer(ri.geometrySubCB);
-        }
+            destroyRenderInfo(ri);
 
         for(auto& si : mSpriteInfos)
         {
@@ -924,11 +1155,16 @@ namespace Lynx
 
         mRenderInfos.clear();
         mSpriteInfos.clear();
-
-        mShadowAdded = false;
-        mGeometryAdded = false;
+        mBatches.clear();
+        mFreeBatches.clear();
+        mBatchIndices.clear();
+        for(uint32_t pass = 0; pass < Batch::ePassNum; ++pass)
+            mBatchOrders[pass].clear();
+
+        //メインのコマンドバッファは破棄したサブコマンドバッファを指したままなので記録し直させる
+        mShadowAdded = mGeometryAdded = true;
+        mSpriteAdded = true;
         mLightingAdded = false;
-        mSpriteAdded = false;
     }
 
     void Renderer::build()
@@ -940,81 +1176,164 @@ namespace Lynx
            return;
         }
         
-        {//各定数バッファを書き込み
-            SceneData sceneData;
-            {//各ジオメトリ共通データ
-                sceneData.view = mCamera.lock()->getViewMatrix();
-                sceneData.proj = mCamera.lock()->getProjectionMatrix();
+        mStatistics = Statistics();
+
+        const auto& camera = mCamera.lock();
+        const uint64_t cameraVersion = camera->getVersion();
+        const float interpolationAlpha = FrameClock::getCurrent().getInterpolationAlpha();
+        const std::shared_ptr<LightComponent> light = mLights.empty() ? nullptr : mLights[0].lock();
+        const uint64_t lightVersion = light ? light->getVersion() : 0;
+        //親がいてもワールドでの位置
+        const glm::vec3 lightPos = light ? glm::vec3(light->getTransform().getWorldMatrix()[3]) : glm::vec3(0);
+
+        //ライトのビュー射影はオブジェクトによらないので先に計算しておく(点光源のビューのみオブジェクトごと)
+        ShadowData shadowData;
+        auto&& shadowProj = glm::perspective(glm::radians(60.f), static_cast<float>(mMaxWidth) / static_cast<float>(mMaxHeight), 1.f, 1000.f);
+        shadowProj[1][1] *= -1;
+        const auto&& matBias =  glm::translate(glm::mat4(1.0f), glm::vec3(0.5f,0.5f,0.5f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f, 0.5f, 0.5f));
+        glm::mat4 shadowView(1.f);
+        const bool pointLight = light && light->getType() == LightComponent::LightType::ePointLight;
+        if (light)
+        {
+            switch (light->getType())
+            {
+            case LightComponent::LightType::eDirectionalLight:
+                shadowView = glm::lookAtRH(light->getDirection() * -10.f, glm::vec3(0, 0, 0), glm::vec3(0, 1.f, 0));
+                break;
+            case LightComponent::LightType::ePointLight:
+                break;
+            default:
+                assert(!"invalid light param type!");
+                break;
             }
+        }
 
-            //for(auto& ri : mRenderInfos)
+        //平行光源の影をカメラの視錐台に合わせる場合はカメラが動いても変わる
+        uint64_t shadowVersion = lightVersion;
+        if(light && !pointLight && mShadowFitToCamera)
+        {
+            fitShadowToCamera(*camera, light->getDirection(), shadowView, shadowProj);
+            shadowVersion = std::max(lightVersion, cameraVersion);
+        }
+
+        shadowData.lightViewProj = shadowProj * shadowView;
+        shadowData.lightViewProjBias = matBias * shadowData.lightViewProj;
+
+        auto count = [this](bool written, size_t size)
+        {
+            if(written)
+            {
+                ++mStatistics.uniformWriteCount;
+                mStatistics.uniformWriteBytes += size;
+            }
+            else
+                ++mStatistics.uniformSkipCount;
+        };
+
+        {//各定数バッファを書き込み
+            BoneData boneData;
+            boneData.useBone = 1;
+            boneData.padding = glm::vec3(0);
+
+            //消えたものを外して、動いたものの境界球を更新する
             mRenderInfos.erase(std::remove_if(mRenderInfos.begin(), mRenderInfos.end(), 
             [&](RenderInfo& ri)
             {
                 if(ri.mesh.expired() && ri.skeletalMesh.expired())
+                {
+                    destroyRenderInfo(ri);
+                    mShadowAdded = mGeometryAdded = true;
                     return true;
-                
+                }
+
+                //固定ステップで回しているときは前回と今回のシミュレーションの間を描く
+                auto& transform = ri.mesh.lock()->getTransform();
+                const auto& world = transform.getRenderMatrix(interpolationAlpha);
+                if(ri.boundsVersion != transform.getRenderVersion())
+                {
+                    updateWorldBounds(ri, world);
+                    ri.boundsVersion = transform.getRenderVersion();
+                }
+
+                return false;
+            }), mRenderInfos.end());
+
+            cull(camera->getProjectionMatrix() * camera->getViewMatrix());
+            if(light)
+                cullShadowCasters(*light, shadowData.lightViewProj);
+
+            SceneData sceneData;
+            {//各ジオメトリ共通データ
+                sceneData.view = camera->getViewMatrix();
+                sceneData.proj = camera->getProjectionMatrix();
+                sceneData.padding = glm::vec2(0);
+            }
+
+            for(auto& ri : mRenderInfos)
+            {
+                auto& transform = ri.mesh.lock()->getTransform();
+                const uint64_t transformVersion = transform.getRenderVersion();
+
                 //ジオメトリ固有パラメータセット
+                //シャドウパスでもworldを使うので、見えなくても影を落とすなら転送する
+                //見送った場合はバージョンが古いままなので、見えるようになったときに転送される
+                if(!ri.inFrustum && !(ri.castShadow && ri.inShadowFrustum))
+                    count(false, sizeof(SceneData));
+                else if(ri.sceneTransformVersion != transformVersion || ri.sceneCameraVersion != cameraVersion)
                 {
-                    sceneData.world = ri.mesh.lock()->getTransform().getWorldMatrix();
+                    sceneData.world = transform.getRenderMatrix(interpolationAlpha);
                     sceneData.receiveShadow = ri.receiveShadow ? 1.f : 0;
                     sceneData.lighting = ri.lighting ? 1.f : 0;
                     mContext->writeBuffer(sizeof(SceneData), &sceneData, ri.sceneUB);
+                    ri.sceneTransformVersion = transformVersion;
+                    ri.sceneCameraVersion = cameraVersion;
+                    count(true, sizeof(SceneData));
                 }
+                else
+                    count(false, sizeof(SceneData));
 
+                if(ri.castShadow && !ri.inShadowFrustum)
+                    count(false, sizeof(ShadowData));
+                else if(ri.castShadow)
                 {
-                    ShadowData data;
-                    glm::mat4 view;
-                    auto& transform = ri.skeletal ? ri.skeletalMesh.lock()->getTransform() : ri.mesh.lock()->getTransform();
-                    if (!mLights.empty())
+                    //平行光源なら物体の位置は関係ない
+                    const uint64_t shadowTransformVersion = pointLight ? transformVersion : 0;
+                    if(ri.shadowLightVersion != shadowVersion || ri.shadowTransformVersion != shadowTransformVersion)
                     {
-                        switch (mLights[0].lock()->getType())
+                        ShadowData data = shadowData;
+                        if(pointLight)
                         {
-                        case LightComponent::LightType::eDirectionalLight:
-                            view = glm::lookAtRH(mLights[0].lock()->getDirection() * -10.f, glm::vec3(0, 0, 0), glm::vec3(0, 1.f, 0));
-                            break;
-                        case LightComponent::LightType::ePointLight:
-                            view = glm::lookAtRH(mLights[0].lock()->getTransform().getPos(), transform.getPos(), glm::vec3(0, 1.f, 0));
-                            break;
-                        default:
-                            assert(!"invalid light param type!");
-                            break;
+                            data.lightViewProj = shadowProj * glm::lookAtRH(lightPos, glm::vec3(transform.getRenderMatrix(interpolationAlpha)[3]), glm::vec3(0, 1.f, 0));
+                            data.lightViewProjBias = matBias * data.lightViewProj;
                         }
-                    }
-
-                    auto&& proj = glm::perspective(glm::radians(60.f), 1.f * mMaxWidth / mMaxHeight, 1.f, 1000.f);
 
-                    proj[1][1] *= -1;
-                    auto&& matBias =  glm::translate(glm::mat4(1.0f), glm::vec3(0.5f,0.5f,0.5f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f, 0.5f, 0.5f));
-                    data.lightViewProj = proj * view;
-                    data.lightViewProjBias = matBias * data.lightViewProj;
-                    mContext->writeBuffer(sizeof(ShadowData), &data, ri.shadowUB);
-                
+                        mContext->writeBuffer(sizeof(ShadowData), &data, ri.shadowUB);
+                        ri.shadowLightVersion = shadowVersion;
+                        ri.shadowTransformVersion = shadowTransformVersion;
+                        count(true, sizeof(ShadowData));
+                    }
+                    else
+                        count(false, sizeof(ShadowData));
                 }
 
-                if(!ri.skeletal)
-                    return false;
-
+                if(ri.skeletal)
                 {
-                    BoneData data;
                     const auto& bones = ri.skeletalMesh.lock()->getBones();
                     const auto&& identity = glm::mat4(0.f);
-                    data.useBone = 1;
                     for(size_t i = 0; i < MAX_BONE_NUM; ++i)
                     {
                         if(i >= bones.size())
                         {
-                            data.boneTransform[i] = identity;
+                            boneData.boneTransform[i] = identity;
                             continue;
                         }
 
-                        data.boneTransform[i] = bones[i].transform;
+                        boneData.boneTransform[i] = bones[i].transform;
                     }
-                    mContext->writeBuffer(sizeof(BoneData), &data, ri.boneUB);
-                    return false;
+                    count(writeIfChanged(*mContext, boneData, *ri.boneCache, ri.boneCached, ri.boneUB), sizeof(BoneData));
+                    ri.boneCached = true;
                 }
-
-            }), mRenderInfos.end());
+            }
 
             {
                 Cutlass::BufferInfo bi;
@@ -1027,7 +1346,12 @@ namespace Lynx
                 [&](SpriteInfo& si)
                 {
                     if(si.sprite.expired())
+                    {
+                        mContext->destroyBuffer(si.VB);
+                        mContext->destroyCommandBuffer(si.spriteSubCB);
+                        mSpriteAdded = true;
                         return true;
+                    }
 
                     lu = ld = ru = rd = glm::vec3(0);
                     const auto& transform = si.sprite.lock()->getTransform();
@@ -1086,14 +1410,33 @@ namespace Lynx
                 }), mSpriteInfos.end());
             }
 
+            if(mCameraVersion != cameraVersion)
             {//カメラ
                 CameraData data;
-                data.cameraPos = mCamera.lock()->getTransform().getPos();
+                data.cameraPos = camera->getTransform().getPos();
                 //std::cerr << "camera pos : " << glm::to_string(data.cameraPos) << "\n";
                 mContext->writeBuffer(sizeof(CameraData), &data, mCameraUB);
+                mCameraVersion = cameraVersion;
+                count(true, sizeof(CameraData));
+            }
+            else
+                count(false, sizeof(CameraData));
+
+            //ライトの数もバージョンも変わっていなければ転送しない
+            bool lightChanged = mLightVersions.size() != mLights.size();
+            mLightVersions.resize(mLights.size());
+            for(size_t i = 0; i < mLights.size(); ++i)
+            {
+                const uint64_t version = mLights[i].expired() ? 0 : mLights[i].lock()->getVersion();
+                lightChanged |= mLightVersions[i] != version;
+                mLightVersions[i] = version;
             }
 
+            if(!lightChanged)
+                count(false, sizeof(LightData) * MAX_LIGHT_NUM);
+            else
             {//ライト
+                count(true, sizeof(LightData) * MAX_LIGHT_NUM);
                 LightData data[MAX_LIGHT_NUM];
 
                 for(uint32_t i = 0; i < MAX_LIGHT_NUM; ++i)
@@ -1112,7 +1455,7 @@ namespace Lynx
                         break;
                         case LightComponent::LightType::ePointLight:
                             data[i].lightType = 1;
-                            data[i].lightPos = mLights[i].lock()->getTransform().getPos();
+                            data[i].lightPos = glm::vec3(mLights[i].lock()->getTransform().getWorldMatrix()[3]);
                             data[i].lightRange = mLights[i].lock()->getRange();
                         break;
                         default:
@@ -1136,57 +1479,156 @@ namespace Lynx
                 {
                     assert(!"failed to create light buffer!");
                 }
+            }
 
-                //shadow用
-                if(mLights.empty())
+            //shadow用
+            if(light && mShadowVersion != shadowVersion)
+            {
+                ShadowData data = shadowData;
+                if(pointLight)
                 {
-                    mShadowAdded = false;
+                    auto view = glm::lookAtRH(lightPos * -10.f, glm::vec3(0, 0, 0), glm::vec3(0, 1.f, 0));
+                    data.lightViewProj = shadowProj * view;
+                    data.lightViewProjBias = matBias * data.lightViewProj;
                 }
-                else
-                {
-                    ShadowData data;
-                    glm::vec3 invDir;
-                    switch(mLights[0].lock()->getType())
-                    {
-                        case LightComponent::LightType::eDirectionalLight:
-                            invDir = mLights[0].lock()->getDirection() * -10.f;
-                        break;
-                        case LightComponent::LightType::ePointLight:
-                            invDir = mLights[0].lock()->getTransform().getPos() * -10.f;
-                        break;
-                        default:
-                            assert(!"invalid light param type!");
-                        break;
-                    }
+                //data.lightViewProj = glm::perspective(glm::radians(45.f), 1.f * width / height, 1.f, 1000.f) * glm::lookAtRH(glm::vec3(0), glm::vec3(0, 0, -10.f), glm::vec3(0, 1.f, 0));
+                mContext->writeBuffer(sizeof(ShadowData), &data, mShadowUB);
+                mShadowVersion = shadowVersion;
+                count(true, sizeof(ShadowData));
+            }
+            else if(light)
+                count(false, sizeof(ShadowData));
 
-                    auto view = glm::lookAtRH(invDir, glm::vec3(0, 0, 0), glm::vec3(0, 1.f, 0));
-                    auto proj = glm::perspective(glm::radians(60.f), 1.f * mMaxWidth / mMaxHeight, 1.f, 1000.f);
+            //ライトがなければ影は描かない
+            if(mLights.empty())
+                mShadowAdded = false;
+        }
 
-                    proj[1][1] *= -1;
-                    auto&& matBias =  glm::translate(glm::mat4(1.0f), glm::vec3(0.5f,0.5f,0.5f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f, 0.5f, 0.5f));
-                    data.lightViewProj = proj * view;
-                    data.lightViewProjBias = matBias * data.lightViewProj;
-                    //data.lightViewProj = glm::perspective(glm::radians(45.f), 1.f * width / height, 1.f, 1000.f) * glm::lookAtRH(glm::vec3(0), glm::vec3(0, 0, -10.f), glm::vec3(0, 1.f, 0));
-                    mContext->writeBuffer(sizeof(ShadowData), &data, mShadowUB);
+        //削除で空いた領域を詰めたらオフセットが変わるので記録し直す
+        if(mMeshRegistry->compact())
+        {
+            for(auto& batch : mBatches)
+                batch.dirty = true;
+
+            mShadowAdded = mGeometryAdded = true;
+        }
+
+        //追加されたメッシュをまとめて転送
+        mMeshRegistry->flush();
+
+        //今回描くRenderInfoをソートキー順に並べてバッチに振り分ける
+        //バッチ内の描画順とバッチの実行順はどちらもキー順になる
+        for(auto& batch : mBatches)
+            for(uint32_t pass = 0; pass < Batch::ePassNum; ++pass)
+                batch.pending[pass].clear();
+
+        for(uint32_t pass = 0; pass < Batch::ePassNum; ++pass)
+            mDrawLists[pass].clear();
+
+        //ジオメトリパスは手前から描く(アーリーZで後ろのピクセルシェーダを省ける)
+        glm::mat4 view(1.f);
+        float farClip = 1.f;
+        const bool depthSort = mDepthSort;
+        if(depthSort)
+        {
+            view = camera->getViewMatrix();
+            farClip = camera->getFar();
+        }
+
+        for(uint32_t i = 0; i < mRenderInfos.size(); ++i)
+        {
+            const auto& ri = mRenderInfos[i];
+            const auto& key = mBatches[ri.batch].key;
+            const uint32_t mesh = key.meshes.empty() ? 0 : key.meshes.front();
+
+            if(ri.castShadow && ri.inShadowFrustum)
+                mDrawLists[Batch::eShadowPass].push_back({makeSortKey(key.shadowPipeline, key.material, mesh, 0), i});
+
+            const auto& meshComponent = ri.skeletal ? static_cast<std::shared_ptr<MeshComponent>>(ri.skeletalMesh.lock()) : ri.mesh.lock();
+            if(ri.inFrustum && meshComponent && meshComponent->getEnable() && meshComponent->getVisible())
+            {
+                uint32_t depth = 0;
+                if(depthSort)
+                {
+                    //ビュー空間ではカメラは-zを向いている
+                    const float z = -(view * glm::vec4(ri.worldCenter, 1.f)).z;
+                    depth = static_cast<uint32_t>(std::clamp(z / farClip, 0.f, 1.f) * sortKeyDepthMask);
                 }
+                mDrawLists[Batch::eGeometryPass].push_back({makeSortKey(key.geometryPipeline, key.material, mesh, depth), i});
+            }
+        }
+
+        bool shadowChanged = mShadowAdded;
+        bool geometryChanged = mGeometryAdded;
+        for(uint32_t pass = 0; pass < Batch::ePassNum; ++pass)
+        {
+            auto& drawList = mDrawLists[pass];
+            radixSort(drawList, mDrawListScratch);
+
+            //最初に出てきた順がバッチの実行順
+            mBatchOrderScratch.clear();
+            for(const auto& item : drawList)
+            {
+                auto& pending = mBatches[mRenderInfos[item.index].batch].pending[pass];
+                if(pending.empty())
+                    mBatchOrderScratch.emplace_back(mRenderInfos[item.index].batch);
+                pending.emplace_back(item.index);
             }
 
+            if(mBatchOrderScratch != mBatchOrders[pass])
+            {
+                mBatchOrders[pass].swap(mBatchOrderScratch);
+                (pass == Batch::eShadowPass ? shadowChanged : geometryChanged) = true;
+            }
+        }
+
+        {//キー順に1本のコマンドで描いたときに必要な状態の切り替え回数
+            const auto& drawList = mDrawLists[Batch::eGeometryPass];
+            for(size_t i = 0; i < drawList.size(); ++i)
+            {
+                const uint64_t prev = i == 0 ? ~drawList[i].key : drawList[i - 1].key;
+                const uint64_t diff = prev ^ drawList[i].key;
+                if(diff & (sortKeyPipelineMask << sortKeyPipelineShift))
+                    ++mStatistics.pipelineChangeCount;
+                if(diff & (sortKeyMaterialMask << sortKeyMaterialShift))
+                    ++mStatistics.materialChangeCount;
+                if(diff & (sortKeyMeshMask << sortKeyMeshShift))
+                    ++mStatistics.meshChangeCount;
+            }
+        }
+
+        //メンバーか並びが変わったバッチだけ記録し直す
+        recordBatches();
+        for(const auto& job : mRecordJobs)
+            (job.pass == Batch::eShadowPass ? shadowChanged : geometryChanged) = true;
+        mStatistics.batchRecordCount = static_cast<uint32_t>(mRecordJobs.size());
+
+        for(const auto& index : mBatchOrders[Batch::eGeometryPass])
+        {
+            if(!mBatches[index].hasSubCB[Batch::eGeometryPass])
+                continue;
+
+            ++mStatistics.batchCount;
+            mStatistics.drawCount += mBatches[index].drawCount[Batch::eGeometryPass];
         }
 
         //サブコマンドバッファ積み込み
-        if(mShadowAdded)
+        if(!mLights.empty() && shadowChanged)
         {
             //std::cerr << "build shadow\n";
             CommandList cl;
 
             cl.begin(mShadowPass);
-            for(const auto& ri : mRenderInfos)
-                cl.executeSubCommand(ri.shadowSubCB);
+            for(const auto& index : mBatchOrders[Batch::eShadowPass])
+                if(mBatches[index].hasSubCB[Batch::eShadowPass])
+                    cl.executeSubCommand(mBatches[index].subCB[Batch::eShadowPass]);
             cl.end();
             mContext->updateCommandBuffer(cl, mShadowCB);
+            ++mStatistics.commandBufferRebuildCount;
             mShadowAdded = false;
         }
-        if(true)
+
+        if(geometryChanged)
         {
             //std::cerr << "build geom\n";
             CommandList cl;
@@ -1194,24 +1636,13 @@ namespace Lynx
             cl.barrier(mGBuffer.normalRT);
             cl.barrier(mGBuffer.worldPosRT);
             cl.begin(mGBuffer.renderPass);
-            for(const auto& ri : mRenderInfos)
-            {
-                if(ri.skeletal)
-                {
-                    if(ri.skeletalMesh.expired() || !ri.skeletalMesh.lock()->getEnable() || !ri.skeletalMesh.lock()->getVisible())
-                        continue;
-                }
-                else
-                {
-                    if(ri.mesh.expired() || !ri.mesh.lock()->getEnable() || !ri.mesh.lock()->getVisible())
-                        continue;
-                }
-
-                cl.executeSubCommand(ri.geometrySubCB);
-            }
+            for(const auto& index : mBatchOrders[Batch::eGeometryPass])
+                if(mBatches[index].hasSubCB[Batch::eGeometryPass])
+                    cl.executeSubCommand(mBatches[index].subCB[Batch::eGeometryPass]);
             cl.end();
             mContext->updateCommandBuffer(cl, mGeometryCB);
-           //mGeometryAdded = false;
+            ++mStatistics.commandBufferRebuildCount;
+            mGeometryAdded = false;
         }
         // if(mForwardAdded)
         // {
@@ -1226,24 +1657,56 @@ namespace Lynx
         {
             mPostEffectAdded = false;
         }
-        if(mSpriteAdded)
+        if(updateVisibility(mSpriteVisibility, mSpriteInfos, [](const SpriteInfo& si)
+        {
+            return !si.sprite.expired() && si.sprite.lock()->getEnable() && si.sprite.lock()->getVisible();
+        }) || mSpriteAdded)
         {
             //std::cerr << "build sprite\n";
             CommandList cl;
             cl.begin(mSpritePass);
-            for(const auto& si : mSpriteInfos)
+            for(size_t i = 0; i < mSpriteInfos.size(); ++i)
             {
-                if(!si.sprite.expired() && si.sprite.lock()->getEnable() && si.sprite.lock()->getVisible())
-                    cl.executeSubCommand(si.spriteSubCB);
+                if(mSpriteVisibility[i])
+                    cl.executeSubCommand(mSpriteInfos[i].spriteSubCB);
             }
             cl.end();
             mContext->updateCommandBuffer(cl, mSpriteCB);
-            //mSpriteAdded = false;
+            ++mStatistics.commandBufferRebuildCount;
+            mSpriteAdded = false;
+        }
+
+        {//1秒ごとに再記録の頻度を集計
+            const auto now = std::chrono::steady_clock::now();
+            mRebuildCountInWindow += mStatistics.commandBufferRebuildCount;
+            const double elapsed = std::chrono::duration<double>(now - mRebuildWindowStart).count();
+            if(elapsed >= 1.0)
+            {
+                mRebuildsPerSecond = static_cast<float>(mRebuildCountInWindow / elapsed);
+                mRebuildCountInWindow = 0;
+                mRebuildWindowStart = now;
+            }
+            mStatistics.commandBufferRebuildsPerSecond = mRebuildsPerSecond;
         }
 
         mSceneBuilded = true;
     }
 
+    bool Renderer::loadPipelineCache(const char* path)
+    {
+        return mPipelineCache->load(path);
+    }
+
+    bool Renderer::savePipelineCache(const char* path) const
+    {
+        return mPipelineCache->save(path);
+    }
+
+    const Renderer::Statistics& Renderer::getStatistics() const
+    {
+        return mStatistics;
+    }
+
     void Renderer::render()
     {
         if(!mSceneBuilded)
@@ -0,0 +1,289 @@
+#include <Lynx/Utility/AnimationClip.hpp>
+
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Lynx
+{
+    namespace
+    {
+        //間引きで1区間にまとめるキー数の上限(読み込み時間がキー数の2乗にならないように)
+        constexpr uint32_t maxReducedSpan = 256;
+
+        //残すキーのインデックスをkeptに入れる, 最初と最後は必ず残す
+        template<typename T, typename Lerp, typename Error>
+        void reduceKeys(const float* times, const T* values, uint32_t count, float tolerance, Lerp&& lerp, Error&& error, std::vector<uint32_t>& kept)
+        {
+            kept.clear();
+            kept.emplace_back(0);
+            if(count == 1)
+                return;
+
+            //全部最初の値とみなせるなら1つで足りる
+            if(tolerance > 0)
+            {
+                bool constant = true;
+                for(uint32_t i = 1; constant && i < count; ++i)
+                    constant = error(values[0], values[i]) <= tolerance;
+
+                if(constant)
+                    return;
+            }
+
+            for(uint32_t i = 1; i + 1 < count; ++i)
+            {
+                //iを捨てても, 最後に残したキーからi + 1への補間で間のキーが全部許容誤差に収まるか
+                const uint32_t start = kept.back();
+                bool removable = tolerance > 0 && i - start < maxReducedSpan && times[i + 1] > times[start];
+                for(uint32_t j = start + 1; removable && j <= i; ++j)
+                {
+                    const float t = (times[j] - times[start]) / (times[i + 1] - times[start]);
+                    removable = error(lerp(values[start], values[i + 1], t), values[j]) <= tolerance;
+                }
+
+                if(!removable)
+                    kept.emplace_back(i);
+            }
+
+            kept.emplace_back(count - 1);
+        }
+
+        //time < times[i + 1]となる最初のi(最後の区間で打ち止め)と, その区間での補間係数
+        //前回のキー(cursor)から数個先までは順に進め、それより先や巻き戻しは二分探索する
+        float findKey(const float* times, uint32_t count, float time, uint32_t& cursor, uint32_t& index)
+        {
+            constexpr uint32_t linearSearchNum = 4;
+
+            assert(count >= 2);
+            const uint32_t last = count - 2;
+
+            uint32_t i = std::min(cursor, last);
+            bool found = false;
+            if(time >= times[i] || i == 0)
+            {
+                for(uint32_t step = 0; step < linearSearchNum && !found; ++step)
+                {
+                    if(i == last || time < times[i + 1])
+                        found = true;
+                    else
+                        ++i;
+                }
+            }
+
+            if(!found)
+            {
+                //times[1]以降で初めてtimeを超えるキーの1つ前
+                const float* upper = std::upper_bound(times + 1, times + count, time);
+                i = std::min(static_cast<uint32_t>(upper - times) - 1, last);
+            }
+
+            cursor = index = i;
+
+            const float dt = times[i + 1] - times[i];
+            return dt > 0 ? std::clamp((time - times[i]) / dt, 0.f, 1.f) : 0;
+        }
+
+        glm::quat lerpRotation(const glm::quat& a, const glm::quat& b, float t)
+        {
+            return glm::normalize(glm::mix(a, b, t));
+        }
+
+        //相対回転conj(a) * bの角度, acosは1付近で精度が出ないのでatan2で
+        float rotationError(const glm::quat& a, const glm::quat& b)
+        {
+            const glm::vec3 va(a.x, a.y, a.z);
+            const glm::vec3 vb(b.x, b.y, b.z);
+            const glm::vec3 v = a.w * vb - b.w * va - glm::cross(va, vb);
+            return 2.f * std::atan2(glm::length(v), std::abs(glm::dot(a, b)));
+        }
+
+        template<typename T>
+        AnimationClip::Track append(std::vector<float>& dstTimes, std::vector<T>& dstValues, const float* times, const std::vector<uint32_t>& kept, const T* values)
+        {
+            AnimationClip::Track track;
+            track.begin = static_cast<uint32_t>(dstTimes.size());
+            track.count = static_cast<uint32_t>(kept.size());
+            for(const auto& k : kept)
+            {
+                dstTimes.emplace_back(times[k]);
+                dstValues.emplace_back(values[k]);
+            }
+
+            return track;
+        }
+    }
+
+    void AnimationPose::resize(size_t nodeNum)
+    {
+        positions.resize(nodeNum);
+        rotations.resize(nodeNum);
+        scales.resize(nodeNum);
+    }
+
+    size_t AnimationPose::size() const
+    {
+        return positions.size();
+    }
+
+    void blendPose(AnimationPose& dst, const AnimationPose& src, float weight, const float* mask)
+    {
+        assert(dst.size() == src.size());
+        for(size_t i = 0; i < dst.size(); ++i)
+        {
+            const float w = mask ? weight * mask[i] : weight;
+            if(w <= 0)
+                continue;
+
+            dst.positions[i] = glm::mix(dst.positions[i], src.positions[i], w);
+            dst.scales[i] = glm::mix(dst.scales[i], src.scales[i], w);
+
+            //近い方を回る
+            const glm::quat& r = src.rotations[i];
+            const glm::quat target = glm::dot(dst.rotations[i], r) < 0 ? glm::quat(-r.w, -r.x, -r.y, -r.z) : r;
+            dst.rotations[i] = lerpRotation(dst.rotations[i], target, w);
+        }
+    }
+
+    void addPose(AnimationPose& dst, const AnimationPose& src, const AnimationPose& reference, float weight, const float* mask)
+    {
+        assert(dst.size() == src.size() && dst.size() == reference.size());
+        const glm::quat identity(1.f, 0, 0, 0);
+        for(size_t i = 0; i < dst.size(); ++i)
+        {
+            const float w = mask ? weight * mask[i] : weight;
+            if(w <= 0)
+                continue;
+
+            dst.positions[i] += (src.positions[i] - reference.positions[i]) * w;
+            dst.scales[i] *= glm::mix(glm::vec3(1.f), src.scales[i] / reference.scales[i], w);
+
+            glm::quat delta = glm::normalize(src.rotations[i] * glm::conjugate(reference.rotations[i]));
+            if(delta.w < 0)
+                delta = glm::quat(-delta.w, -delta.x, -delta.y, -delta.z);
+            dst.rotations[i] = glm::normalize(lerpRotation(identity, delta, w) * dst.rotations[i]);
+        }
+    }
+
+    AnimationClip::AnimationClip()
+    : duration(0)
+    {
+
+    }
+
+    AnimationClip::Track AnimationClip::addPositions(const float* times, const glm::vec3* values, uint32_t count, float tolerance)
+    {
+        assert(count > 0);
+        std::vector<uint32_t> kept;
+        reduceKeys(times, values, count, tolerance, [](const glm::vec3& a, const glm::vec3& b, float t){ return glm::mix(a, b, t); }, [](const glm::vec3& a, const glm::vec3& b){ return glm::length(a - b); }, kept);
+        return append(positionTimes, positions, times, kept, values);
+    }
+
+    AnimationClip::Track AnimationClip::addRotations(const float* times, const glm::quat* values, uint32_t count, float tolerance)
+    {
+        assert(count > 0);
+        std::vector<uint32_t> kept;
+        reduceKeys(times, values, count, tolerance, lerpRotation, rotationError, kept);
+
+        Track track;
+        track.begin = static_cast<uint32_t>(rotationTimes.size());
+        track.count = static_cast<uint32_t>(kept.size());
+        for(const auto& k : kept)
+        {
+            rotationTimes.emplace_back(times[k]);
+            rotations.emplace_back(quantize(values[k]));
+        }
+
+        return track;
+    }
+
+    AnimationClip::Track AnimationClip::addScales(const float* times, const glm::vec3* values, uint32_t count, float tolerance)
+    {
+        assert(count > 0);
+        std::vector<uint32_t> kept;
+        reduceKeys(times, values, count, tolerance, [](const glm::vec3& a, const glm::vec3& b, float t){ return glm::mix(a, b, t); }, [](const glm::vec3& a, const glm::vec3& b){ return glm::length(a - b); }, kept);
+        return append(scaleTimes, scales, times, kept, values);
+    }
+
+    glm::vec3 AnimationClip::samplePosition(const Track& track, float time, uint32_t& cursor) const
+    {
+        assert(track.count > 0);
+        if(track.count == 1)
+            return positions[track.begin];
+
+        uint32_t i;
+        const float t = findKey(&positionTimes[track.begin], track.count, time, cursor, i);
+        return glm::mix(positions[track.begin + i], positions[track.begin + i + 1], t);
+    }
+
+    glm::quat AnimationClip::sampleRotation(const Track& track, float time, uint32_t& cursor) const
+    {
+        assert(track.count > 0);
+        if(track.count == 1)
+            return glm::normalize(dequantize(rotations[track.begin]));
+
+        uint32_t i;
+        const float t = findKey(&rotationTimes[track.begin], track.count, time, cursor, i);
+        return lerpRotation(dequantize(rotations[track.begin + i]), dequantize(rotations[track.begin + i + 1]), t);
+    }
+
+    glm::vec3 AnimationClip::sampleScale(const Track& track, float time, uint32_t& cursor) const
+    {
+        assert(track.count > 0);
+        if(track.count == 1)
+            return scales[track.begin];
+
+        uint32_t i;
+        const float t = findKey(&scaleTimes[track.begin], track.count, time, cursor, i);
+        return glm::mix(scales[track.begin + i], scales[track.begin + i + 1], t);
+    }
+
+    void AnimationClip::samplePose(float time, const AnimationPose& bindPose, uint32_t* cursors, AnimationPose& out) const
+    {
+        assert(bindPose.size() == channels.size() && out.size() == channels.size());
+        for(size_t i = 0; i < channels.size(); ++i)
+        {
+            const auto& channel = channels[i];
+            if(channel.position.count == 0)
+            {
+                out.positions[i] = bindPose.positions[i];
+                out.rotations[i] = bindPose.rotations[i];
+                out.scales[i] = bindPose.scales[i];
+                continue;
+            }
+
+            out.scales[i] = sampleScale(channel.scale, time, cursors[i * 3]);
+            out.rotations[i] = sampleRotation(channel.rotation, time, cursors[i * 3 + 1]);
+            out.positions[i] = samplePosition(channel.position, time, cursors[i * 3 + 2]);
+        }
+    }
+
+    size_t AnimationClip::getMemorySize() const
+    {
+        return sizeof(AnimationClip)
+            + channels.size() * sizeof(Channel)
+            + (positionTimes.size() + rotationTimes.size() + scaleTimes.size()) * sizeof(float)
+            + positions.size() * sizeof(glm::vec3)
+            + rotations.size() * sizeof(QuantizedQuat)
+            + scales.size() * sizeof(glm::vec3);
+    }
+
+    QuantizedQuat AnimationClip::quantize(const glm::quat& q)
+    {
+        const auto toFixed = [](float v)
+        {
+            return static_cast<int16_t>(std::lround(std::clamp(v, -1.f, 1.f) * 32767.f));
+        };
+
+        const glm::quat n = glm::normalize(q);
+        return QuantizedQuat{toFixed(n.x), toFixed(n.y), toFixed(n.z), toFixed(n.w)};
+    }
+
+    glm::quat AnimationClip::dequantize(const QuantizedQuat& q)
+    {
+        constexpr float scale = 1.f / 32767.f;
+        return glm::quat(q.w * scale, q.x * scale, q.y * scale, q.z * scale);
+    }
+}
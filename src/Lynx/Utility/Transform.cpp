@@ -1,85 +1,139 @@
 #include <Lynx/Utility/Transform.hpp>
+#include <Lynx/Utility/Version.hpp>
+#include <Lynx/System/FrameClock.hpp>
 
 #include <glm/gtx/transform.hpp>
 //#include <glm/gtc/matrix_transform.hpp> 
 
-#include <chrono>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <iostream>
+#include <functional>
 
 namespace Lynx
 {
+    namespace
+    {
+        //translate(pos) * rotate(angle, axis) * scale(scale)を行列の積なしで直接組み立てる
+        //回転はロドリゲスの公式 R = cI + s[k]x + (1 - c)kk^T
+        glm::mat4 composeTRS(const glm::vec3& pos, float angle, const glm::vec3& axis, const glm::vec3& scale)
+        {
+            const glm::vec3 k = glm::normalize(axis);
+            const float s = std::sin(angle), c = std::cos(angle);
+            const glm::vec3 t = (1.f - c) * k;
+
+            glm::mat4 m;
+            m[0] = glm::vec4((t.x * k.x + c) * scale.x, (t.x * k.y + s * k.z) * scale.x, (t.x * k.z - s * k.y) * scale.x, 0.f);
+            m[1] = glm::vec4((t.y * k.x - s * k.z) * scale.y, (t.y * k.y + c) * scale.y, (t.y * k.z + s * k.x) * scale.y, 0.f);
+            m[2] = glm::vec4((t.z * k.x + s * k.y) * scale.z, (t.z * k.y - s * k.x) * scale.z, (t.z * k.z + c) * scale.z, 0.f);
+            m[3] = glm::vec4(pos, 1.f);
+            return m;
+        }
+    }
 
     Transform::Transform()
-    : mWorld(glm::identity<glm::mat4>())
-    , mPos(0)
+    : mPos(0)
     , mVel(0)
     , mAcc(0)
+    , mScale(1.f)
+    , mRotAxis(glm::vec3(0, 1.f, 0))
     , mRotAngle(0)
     , mRotVel(0)
     , mRotAcc(0)
-    , mRotAxis(glm::vec3(0, 1.f, 0))
-    , mScale(1.f)
-    , mPrev(std::chrono::high_resolution_clock::now())
+    , mLocal(glm::identity<glm::mat4>())
+    , mVersion(issueVersion())
+    , mDirty(false)
+    , mPrevPos(0)
+    , mTickPos(0)
+    , mPrevScale(1.f)
+    , mTickScale(1.f)
+    , mPrevRotAngle(0)
+    , mTickRotAngle(0)
+    , mLocalRender(glm::identity<glm::mat4>())
+    , mRenderAlpha(1.f)
+    , mRenderSource(0)
+    , mLocalRenderVersion(mVersion)
+    , mParent(nullptr)
+    , mWorld(glm::identity<glm::mat4>())
+    , mWorldVersion(0)
+    , mRender(glm::identity<glm::mat4>())
+    , mRenderLocalSource(0)
+    , mRenderParentSource(0)
+    , mRenderVersion(mVersion)
     {
 
     }
 
+    //setPos(), setScale(), setRotation()は瞬間移動として扱い, 補間の始点も合わせる
+    //そうしないと作った直後や置き直した直後に前の位置(最初は原点)から滑ってくる
     void Transform::setPos(const glm::vec3& pos)
     {
-        mPos = pos;
+        mPos = mPrevPos = mTickPos = pos;
+        mDirty = true;
     }
 
     void Transform::setVel(const glm::vec3& vel)
     {
         mVel = vel;
+        mDirty = true;
     }
 
     void Transform::setAcc(const glm::vec3& acc)
     {
         mAcc = acc;
+        mDirty = true;
     }
 
     void Transform::setScale(const glm::vec3& scale)
     {
-        mScale = scale;
+        mScale = mPrevScale = mTickScale = scale;
+        mDirty = true;
     }
 
     void Transform::setRotation(const glm::vec3& rotAxis, float angle)
     {
         mRotAxis = rotAxis;
-        mRotAngle = angle;
+        mRotAngle = mPrevRotAngle = mTickRotAngle = angle;
+        mDirty = true;
     }
 
     void Transform::setRotation(float angle)
     {
-        mRotAngle = angle;
+        mRotAngle = mPrevRotAngle = mTickRotAngle = angle;
+        mDirty = true;
     }
 
     void Transform::setRotAxis(const glm::vec3& rotAxis)
     {
         mRotAxis = rotAxis;
+        mDirty = true;
     }
 
     void Transform::setRotVel(const glm::vec3& rotAxis, float angleVel)
     {
         mRotAxis = rotAxis;
         mRotVel = angleVel;
+        mDirty = true;
     }
 
     void Transform::setRotVel(float angleVel)
     {
         mRotVel = angleVel;
+        mDirty = true;
     }
 
     void Transform::setRotAcc(const glm::vec3& rotAxis, float angleAcc)
     {
         mRotAxis = rotAxis;
         mRotAcc = angleAcc;
+        mDirty = true;
     }
 
     void Transform::setRotAcc(float angleAcc)
     {
         mRotAcc = angleAcc;
+        mDirty = true;
     }
 
     const glm::vec3& Transform::getPos() const
@@ -117,22 +171,126 @@ namespace Lynx
         return mRotVel;
     }
 
+    void Transform::setParent(Transform* parent)
+    {
+#ifndef NDEBUG
+        for(auto ancestor = parent; ancestor; ancestor = ancestor->mParent)
+            assert(ancestor != this);
+#endif
+        //自分の行列は同じでもワールド行列は変わる, 親の番号が自分より古いとmaxでは拾えない
+        mParent = parent;
+        mVersion = issueVersion();
+    }
+
+    Transform* Transform::getParent() const
+    {
+        return mParent;
+    }
+
+    const glm::mat4& Transform::getLocalMatrix() const
+    {
+        return mLocal;
+    }
+
     const glm::mat4& Transform::getWorldMatrix()
     {
+        if(!mParent)
+            return mLocal;
+
+        //自分か祖先のどれかが動いていれば掛け直す
+        const uint64_t version = getVersion();
+        if(mWorldVersion != version)
+        {
+            mWorld = mParent->getWorldMatrix() * mLocal;
+            mWorldVersion = version;
+        }
+
         return mWorld;
     }
 
+    uint64_t Transform::getVersion() const
+    {
+        //通し番号は増えていくだけなので、大きい方が変わればどちらかが変わっている
+        return mParent ? std::max(mVersion, mParent->getVersion()) : mVersion;
+    }
+
+    const glm::mat4& Transform::getRenderMatrix(float alpha)
+    {
+        const glm::mat4& local = getLocalRenderMatrix(alpha);
+        if(!mParent)
+        {
+            mRenderVersion = mLocalRenderVersion;
+            return local;
+        }
+
+        const glm::mat4& parent = mParent->getRenderMatrix(alpha);
+        const uint64_t parentVersion = mParent->getRenderVersion();
+        if(mRenderLocalSource != mLocalRenderVersion || mRenderParentSource != parentVersion)
+        {
+            mRender = parent * local;
+            mRenderLocalSource = mLocalRenderVersion;
+            mRenderParentSource = parentVersion;
+            mRenderVersion = issueVersion();
+        }
+
+        return mRender;
+    }
+
+    const glm::mat4& Transform::getLocalRenderMatrix(float alpha)
+    {
+        const std::equal_to<float> equal;
+        if(alpha >= 1.f || (mPrevPos == mTickPos && mPrevScale == mTickScale && equal(mPrevRotAngle, mTickRotAngle)))
+        {
+            mLocalRenderVersion = mVersion;
+            return mLocal;
+        }
+
+        if(!equal(mRenderAlpha, alpha) || mRenderSource != mVersion)
+        {
+            const glm::vec3 pos = glm::mix(mPrevPos, mTickPos, alpha);
+            const glm::vec3 scale = glm::mix(mPrevScale, mTickScale, alpha);
+            const float angle = glm::mix(mPrevRotAngle, mTickRotAngle, alpha);
+            mLocalRender = composeTRS(pos, angle, mRotAxis, scale);
+            mRenderAlpha = alpha;
+            mRenderSource = mVersion;
+            mLocalRenderVersion = issueVersion();
+        }
+
+        return mLocalRender;
+    }
+
+    uint64_t Transform::getRenderVersion() const
+    {
+        return mRenderVersion;
+    }
+
     void Transform::update()
     {
-        static float deltaTime = 0;
-        auto&& now = std::chrono::high_resolution_clock::now();
-        deltaTime = std::chrono::duration_cast<std::chrono::microseconds>(now - mPrev).count() / 1000000.;
+        const float deltaTime = FrameClock::getCurrent().getDeltaTime();
+
+        //補間の始点は前回のupdate()を抜けたときの値
+        mPrevPos = mTickPos;
+        mPrevScale = mTickScale;
+        mPrevRotAngle = mTickRotAngle;
+
+        //止まっていて何も設定されていなければワールド行列は変わらない
+        //0と厳密に比べたいので-Wfloat-equalを避けてequal_toで
+        const std::equal_to<float> equal;
+        const bool moving = mVel != glm::vec3(0) || mAcc != glm::vec3(0) || !equal(mRotVel, 0) || !equal(mRotAcc, 0);
+        if(!mDirty && !moving)
+            return;
+
         mPos += deltaTime * (mVel += (deltaTime * mAcc));
         mRotAngle += deltaTime * (mRotVel += (deltaTime * mRotAcc));
         //std::cout << "transform pos : " << mPos.x << "," << mPos.y << "," << mPos.z << "\n";
 
-        mWorld = glm::translate(glm::mat4(1.f), mPos) * glm::rotate(mRotAngle, mRotAxis) * glm::scale(mScale); 
-        mPrev = now;
+        mLocal = composeTRS(mPos, mRotAngle, mRotAxis, mScale);
+        mVersion = issueVersion();
+        mDirty = false;
+
+        mTickPos = mPos;
+        mTickScale = mScale;
+        mTickRotAngle = mRotAngle;
         
         // for(int i = 0; i < 4; ++i)
         // {